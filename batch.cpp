@@ -0,0 +1,187 @@
+#include "batch.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <atomic>
+
+#include "graph.hpp"
+#include "graphLoader.hpp"
+#include "embedder.hpp"
+#include "threadPool.hpp"
+#include "kuratowski.hpp"
+#include "dartIndex.hpp"
+#include "resultCache.hpp"
+
+namespace {
+    // hands out the paths one at a time, first the given ones then the lines of the list
+    class PathSource {
+    private:
+        const std::vector<std::string>& paths_m;
+        std::ifstream listFile_m{};
+        std::istream* list_m{nullptr};
+        int nextIndex_m{0};
+        std::mutex mutex_m{};
+
+    public:
+        PathSource(const std::vector<std::string>& paths, const std::string& listPath) : paths_m(paths) {
+            if (listPath == "-") list_m = &std::cin;
+            else if (!listPath.empty()) {
+                listFile_m.open(listPath);
+                list_m = &listFile_m;
+            }
+        }
+
+        // false if the list file could not be opened
+        bool isOpen() const {
+            return list_m != &listFile_m || listFile_m.is_open();
+        }
+
+        // empty lines and lines starting with # are skipped
+        bool next(std::string& path, int& index) {
+            std::lock_guard<std::mutex> lock(mutex_m);
+            if (nextIndex_m < paths_m.size()) {
+                path = paths_m[nextIndex_m];
+                index = nextIndex_m++;
+                return true;
+            }
+            while (list_m != nullptr && std::getline(*list_m, path)) {
+                if (!path.empty() && path.back() == '\r') path.pop_back();
+                if (path.empty() || path[0] == '#') continue;
+                index = nextIndex_m++;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    void writeJsonString(std::ostream& output, const std::string& text) {
+        output << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') output << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20) output << ' ';
+            else output << c;
+        }
+        output << '"';
+    }
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+    }
+}
+
+int runBatch(const std::vector<std::string>& paths, const BatchOptions& options) {
+    PathSource source(paths, options.listPath);
+    if (!source.isOpen()) {
+        std::cerr << "Error: Could not open file " << options.listPath << std::endl;
+        return 1;
+    }
+    std::mutex outputMutex{};
+    std::atomic<int> numberOfGraphs{0};
+    std::atomic<int> numberOfPlanar{0};
+    std::atomic<int> numberOfFiltered{0};
+    std::atomic<int> numberOfErrors{0};
+    std::unique_ptr<ResultCache> cache{};
+    if (!options.cacheDirectory.empty()) {
+        cache = std::make_unique<ResultCache>(options.cacheDirectory, options.cacheBytes);
+        if (!cache->isOpen()) {
+            std::cerr << "Error: Could not open cache directory " << options.cacheDirectory << std::endl;
+            return 1;
+        }
+    }
+    std::vector<std::unique_ptr<Embedder>> embedders{};
+    for (int worker = 0; worker < options.numberOfThreads; ++worker) {
+        embedders.push_back(std::make_unique<Embedder>());
+        embedders.back()->setSeriesReduction(options.isSeriesReductionEnabled);
+        embedders.back()->setStatistics(options.isStatisticsEnabled);
+        embedders.back()->setWitnessExtraction(options.isWitnessEnabled);
+        embedders.back()->setCache(cache.get());
+    }
+    auto start = std::chrono::steady_clock::now();
+    ThreadPool threadPool(options.numberOfThreads);
+    for (int i = 0; i < options.numberOfThreads; ++i) {
+        threadPool.submit([&](int worker) {
+            Embedder& embedder = *embedders[worker];
+            GraphLoader loader{};
+            loader.setBinaryVerification(options.isBinaryVerificationEnabled);
+            std::string path{};
+            int index{};
+            while (source.next(path, index)) {
+                std::ostringstream line{};
+                line << "{\"index\":" << index << ",\"file\":";
+                writeJsonString(line, path);
+                auto loadStart = std::chrono::steady_clock::now();
+                const char* loadError{};
+                std::optional<MyGraph> loadedGraph = loader.loadFromFile(path.data(), loadError);
+                double loadTime = millisecondsSince(loadStart);
+                if (!loadedGraph) {
+                    ++numberOfErrors;
+                    line << ",\"error\":";
+                    writeJsonString(line, loadError);
+                    line << "}\n";
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cout << line.str();
+                    continue;
+                }
+                const MyGraph& graph = loadedGraph.value();
+                auto embedStart = std::chrono::steady_clock::now();
+                std::optional<Embedding> embedding = embedder.embed(graph);
+                double embedTime = millisecondsSince(embedStart);
+                ++numberOfGraphs;
+                if (embedding.has_value()) ++numberOfPlanar;
+                if (embedder.getDecidingFilter() != PlanarityFilter::None) ++numberOfFiltered;
+                line << ",\"nodes\":" << graph.size() << ",\"edges\":" << graph.numberOfEdges()
+                     << ",\"planar\":" << (embedding.has_value() ? "true" : "false")
+                     << ",\"filter\":\"" << filterName(embedder.getDecidingFilter()) << "\""
+                     << ",\"load_ms\":" << loadTime << ",\"load_mb_s\":" << loader.getLastThroughput()
+                     << ",\"embed_ms\":" << embedTime;
+                if (cache != nullptr) line << ",\"cached\":" << (embedder.isLastResultCached() ? "true" : "false");
+                if (options.isCheckEnabled && embedding.has_value()) {
+                    const char* error = checkEmbedding(graph, embedding.value());
+                    if (error != nullptr) line << ",\"check_error\":\"" << error << "\"";
+                    else line << ",\"faces\":" << DartIndex(embedding.value()).numberOfFaces();
+                }
+                if (options.isWitnessEnabled && !embedding.has_value()) {
+                    const std::vector<std::pair<int, int>>& witness = embedder.getWitness();
+                    const char* error = checkKuratowskiSubdivision(graph, witness);
+                    if (error != nullptr) line << ",\"witness_error\":\"" << error << "\"";
+                    else line << ",\"witness\":\"" << kuratowskiGraphName(witness) << "\",\"witness_edges\":" << witness.size();
+                }
+                if (options.isStatisticsEnabled) {
+                    line << ",\"stats\":";
+                    embedder.getStatistics().writeJson(line);
+                }
+                if (embedding.has_value() && (options.format != EmbeddingFormat::None || options.isSvgEnabled)) {
+                    std::string outputPath = "embedding" + std::to_string(index+1);
+                    std::string path = outputPath + embeddingFileExtension(options.format);
+                    // the files that could not be written, in one output_error
+                    std::string failedPaths{};
+                    if (options.format != EmbeddingFormat::None && !saveEmbedding(embedding.value(), options.format, path))
+                        failedPaths += " " + path;
+                    std::string svgPath = outputPath + ".svg";
+                    if (options.isSvgEnabled && !(options.isOgdfLayoutEnabled ? embedding.value().saveToOgdfSvg(svgPath) : embedding.value().saveToSvg(svgPath)))
+                        failedPaths += " " + svgPath;
+                    if (!failedPaths.empty()) {
+                        ++numberOfErrors;
+                        line << ",\"output_error\":";
+                        writeJsonString(line, "cannot write" + failedPaths);
+                    }
+                }
+                line << "}\n";
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cout << line.str();
+            }
+        });
+    }
+    threadPool.wait();
+    std::cout.flush();
+    std::cerr << "graphs: " << numberOfGraphs << ", planar: " << numberOfPlanar << ", non planar: "
+              << numberOfGraphs-numberOfPlanar << " (" << numberOfFiltered << " rejected by filters), errors: "
+              << numberOfErrors << ", time: " << millisecondsSince(start) << " ms\n";
+    if (cache != nullptr) cache->getStatistics().print(std::cerr);
+    return numberOfErrors;
+}
\ No newline at end of file
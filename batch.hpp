@@ -0,0 +1,40 @@
+#ifndef MY_BATCH_H
+#define MY_BATCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "embeddingWriter.hpp"
+
+struct BatchOptions {
+    int numberOfThreads{1};
+    bool isSeriesReductionEnabled{true};
+    bool isSvgEnabled{false};
+    // svg laid out by OGDF instead of PlanarDrawing
+    bool isOgdfLayoutEnabled{false};
+    // saves the embedding of graph i as embedding<i+1> with the extension of the format
+    EmbeddingFormat format{EmbeddingFormat::None};
+    bool isBinaryVerificationEnabled{false};
+    // adds the embedder statistics to each JSON line
+    bool isStatisticsEnabled{false};
+    // adds the checked K5 or K3,3 subdivision of each non planar graph (filters are skipped)
+    bool isWitnessEnabled{false};
+    // checks each embedding and adds its number of faces
+    bool isCheckEnabled{false};
+    // directory of the ResultCache shared by the workers, none if empty
+    std::string cacheDirectory{};
+    uint64_t cacheBytes{uint64_t(1) << 30};
+    // file with one graph path per line ("-" for standard input), read while graphs are embedded
+    std::string listPath{};
+};
+
+// embeds the graphs in paths and in the list file on a thread pool (each worker with its own
+// sequential Embedder), writing one JSON line per graph to standard output as soon as it is
+// done, so output lines are not in input order (each has the index of its graph);
+// only one graph per worker is in memory at any time, whatever the number of graphs.
+// returns the number of graphs that could not be read or whose embedding could not be saved
+// (1 if the list file or the cache directory cannot be opened)
+int runBatch(const std::vector<std::string>& paths, const BatchOptions& options);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <utility>
+
+#include "graph.hpp"
+#include "embedder.hpp"
+#include "graphGenerator.hpp"
+#include "incrementalEmbedder.hpp"
+
+namespace {
+    double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+    }
+
+    // the edges of graph in random order, inserted one at a time into an IncrementalEmbedder,
+    // against one embedding of the whole graph from scratch (what each insertion costs without it)
+    void benchmarkIncremental(const std::string& family, const MyGraph& graph, uint64_t seed, Embedder& embedder,
+            double& milliseconds) {
+        std::vector<std::pair<int, int>> edges{};
+        edges.reserve(graph.numberOfEdges());
+        for (int node = 0; node < graph.size(); ++node)
+            for (int neighbor : graph.getNeighborsOfNode(node))
+                if (node < neighbor) edges.push_back(std::make_pair(node, neighbor));
+        std::mt19937_64 random(seed);
+        std::shuffle(edges.begin(), edges.end(), random);
+        auto start = std::chrono::steady_clock::now();
+        IncrementalEmbedder incrementalEmbedder(graph.size());
+        int numberOfAccepted = 0;
+        for (const auto& [from, to] : edges)
+            if (incrementalEmbedder.addEdge(from, to)) ++numberOfAccepted;
+        milliseconds = millisecondsSince(start);
+        start = std::chrono::steady_clock::now();
+        embedder.embed(graph);
+        double fullMilliseconds = millisecondsSince(start);
+        const IncrementalCounters& counters = incrementalEmbedder.getCounters();
+        std::cout << family << "," << graph.size() << "," << edges.size() << "," << numberOfAccepted << ","
+            << counters.joinedComponents << "," << counters.onCommonFace << "," << counters.reembedded << ","
+            << counters.rejected << "," << counters.reembeddedEdges << "," << milliseconds << ","
+            << 1000*milliseconds/std::max<size_t>(1, edges.size()) << "," << fullMilliseconds << std::endl;
+    }
+
+    // graphs per second of the general embedder and of SmallGraphEmbedder on the same graphs
+    // (numberOfGraphs of the family, one per seed), which must get the same verdicts
+    void benchmarkSmallGraphs(const std::string& family, int numberOfNodes, int numberOfGraphs, uint64_t seed) {
+        std::vector<MyGraph> graphs{};
+        graphs.reserve(numberOfGraphs);
+        for (int i = 0; i < numberOfGraphs; ++i)
+            graphs.push_back(GraphGenerator(seed+i).generate(family, numberOfNodes));
+        Embedder embedder{};
+        double graphsPerSecond[2]{};
+        std::vector<bool> isPlanar[2]{};
+        for (int isSmall = 0; isSmall < 2; ++isSmall) {
+            embedder.setSmallGraphEngine(isSmall == 1);
+            auto start = std::chrono::steady_clock::now();
+            for (const MyGraph& graph : graphs)
+                isPlanar[isSmall].push_back(embedder.embed(graph).has_value());
+            graphsPerSecond[isSmall] = 1000*numberOfGraphs/std::max(1e-6, millisecondsSince(start));
+        }
+        if (isPlanar[0] != isPlanar[1])
+            std::cerr << "Error: Different results for " << family << " with " << numberOfNodes << " nodes" << std::endl;
+        std::cout << family << "," << graphs.front().size() << "," << graphs.front().numberOfEdges() << ","
+            << numberOfGraphs << "," << std::count(isPlanar[1].begin(), isPlanar[1].end(), true) << ","
+            << graphsPerSecond[0] << "," << graphsPerSecond[1] << "," << graphsPerSecond[1]/graphsPerSecond[0] << std::endl;
+    }
+}
+
+// usage: benchmark [options] [family1 family2 ...]   (all families if none is given)
+//   --min-nodes N    smallest graphs (default 1000)
+//   --max-nodes N    largest graphs (default 10000000)
+//   --steps K        sizes per factor of 10 (default 2)
+//   --repeat R       embeddings per size, the fastest one is reported (default 3)
+//   --time-limit S   a family stops growing when its next size, assuming quadratic
+//                    growth, would take more than S seconds (default 60)
+//   --seed S         seed of the generators (default 1)
+//   --threads N      threads used to embed each graph
+//   --no-reduction   do not contract paths of nodes of degree 2
+//   --incremental    inserts the edges of each graph one at a time, in random order, into an
+//                    IncrementalEmbedder (one CSV line per family and size, with how the edges
+//                    were handled and the time of one embedding from scratch of the whole graph)
+//   --small N        embeds N graphs of each family with 8, 16, 32 and 64 nodes, with and without
+//                    SmallGraphEmbedder (one CSV line per family and size, in graphs per second)
+// prints one CSV line per family and size: time per node and per edge should stay flat,
+// any super linear phase shows up as a growing column
+// large graphs need a large stack (ulimit -s unlimited)
+int main(int argc, char* argv[]) {
+    double minNodes = 1e3;
+    double maxNodes = 1e7;
+    int steps = 2;
+    int repeat = 3;
+    double timeLimit = 60;
+    uint64_t seed = 1;
+    int numberOfThreads = 1;
+    bool isSeriesReductionEnabled = true;
+    bool isIncremental = false;
+    int numberOfSmallGraphs = 0;
+    std::vector<std::string> families{};
+    for (int i = 1; i < argc; ++i) {
+        std::string argument(argv[i]);
+        if (argument == "--min-nodes" && i+1 < argc) minNodes = std::stod(argv[++i]);
+        else if (argument == "--max-nodes" && i+1 < argc) maxNodes = std::stod(argv[++i]);
+        else if (argument == "--steps" && i+1 < argc) steps = std::max(1, std::stoi(argv[++i]));
+        else if (argument == "--repeat" && i+1 < argc) repeat = std::max(1, std::stoi(argv[++i]));
+        else if (argument == "--time-limit" && i+1 < argc) timeLimit = std::stod(argv[++i]);
+        else if (argument == "--seed" && i+1 < argc) seed = std::stoull(argv[++i]);
+        else if (argument == "--threads" && i+1 < argc) numberOfThreads = std::max(1, std::stoi(argv[++i]));
+        else if (argument == "--no-reduction") isSeriesReductionEnabled = false;
+        else if (argument == "--incremental") isIncremental = true;
+        else if (argument == "--small" && i+1 < argc) numberOfSmallGraphs = std::max(1, std::stoi(argv[++i]));
+        else {
+            const std::vector<std::string>& known = GraphGenerator::getFamilies();
+            if (std::find(known.begin(), known.end(), argument) == known.end()) {
+                std::cerr << "Error: Unknown graph family " << argument << std::endl;
+                return 1;
+            }
+            families.push_back(argument);
+        }
+    }
+    if (families.empty()) families = GraphGenerator::getFamilies();
+    if (numberOfSmallGraphs > 0) {
+        std::cout << "family,nodes,edges,graphs,planar,general_graphs_per_s,small_graphs_per_s,speedup\n";
+        std::cout << std::fixed << std::setprecision(3);
+        for (const std::string& family : families)
+            for (int numberOfNodes : {8, 16, 32, 64})
+                benchmarkSmallGraphs(family, numberOfNodes, numberOfSmallGraphs, seed);
+        return 0;
+    }
+    const GraphGenerator generator(seed);
+    Embedder embedder(numberOfThreads);
+    embedder.setSeriesReduction(isSeriesReductionEnabled);
+    if (isIncremental) std::cout << "family,nodes,edges,accepted,joined,on_face,reembedded,rejected,reembedded_edges,incremental_ms,us_per_edge,full_embed_ms\n";
+    else std::cout << "family,nodes,edges,planar,filter,generate_ms,embed_ms,ns_per_node,ns_per_edge\n";
+    std::cout << std::fixed << std::setprecision(3);
+    for (const std::string& family : families) {
+        for (int step = 0; ; ++step) {
+            double target = minNodes*std::pow(10.0, double(step)/steps);
+            if (target > maxNodes*1.0001) break;
+            auto start = std::chrono::steady_clock::now();
+            const MyGraph graph = generator.generate(family, int(std::llround(target)));
+            double generateMilliseconds = millisecondsSince(start);
+            if (isIncremental) {
+                double milliseconds = 0;
+                benchmarkIncremental(family, graph, seed, embedder, milliseconds);
+                if (milliseconds*std::pow(10.0, 2.0/steps) > 1000*timeLimit) break;
+                continue;
+            }
+            double bestMilliseconds = 0;
+            bool isPlanar = false;
+            for (int run = 0; run < repeat; ++run) {
+                start = std::chrono::steady_clock::now();
+                isPlanar = embedder.embed(graph).has_value();
+                double milliseconds = millisecondsSince(start);
+                if (run == 0 || milliseconds < bestMilliseconds) bestMilliseconds = milliseconds;
+                // a single slow run is enough to know the size
+                if (milliseconds > 1000*timeLimit/10) break;
+            }
+            if (isPlanar != GraphGenerator::isPlanarFamily(family))
+                std::cerr << "Error: Wrong result for " << family << " with " << graph.size() << " nodes" << std::endl;
+            double nanoseconds = 1e6*bestMilliseconds;
+            std::cout << family << "," << graph.size() << "," << graph.numberOfEdges() << ","
+                << (isPlanar ? "true" : "false") << "," << filterName(embedder.getDecidingFilter()) << ","
+                << generateMilliseconds << "," << bestMilliseconds << ","
+                << nanoseconds/std::max(1, graph.size()) << ","
+                << nanoseconds/std::max(1, graph.numberOfEdges()) << std::endl;
+            double growth = std::pow(10.0, 2.0/steps);
+            if (bestMilliseconds*growth > 1000*timeLimit) break;
+        }
+    }
+    return 0;
+}
\ No newline at end of file
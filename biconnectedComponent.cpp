@@ -5,17 +5,17 @@
 
 #include "utils.hpp"
 
-Component::Component(int numberOfNodes, const MyGraph& graph)
-: MyGraph(numberOfNodes), originalGraph_m(graph) {
-    nodeLabel_m.resize(numberOfNodes);
-    for (int i = 0; i < numberOfNodes; ++i)
+Component::Component(const GraphBuilder& builder, const MyGraph& graph)
+: MyGraph(builder), originalGraph_m(graph) {
+    nodeLabel_m.resize(size());
+    for (int i = 0; i < size(); ++i)
         nodeLabel_m[i] = -1;
 }
 
 void Component::print() const {
     for (int node = 0; node < size(); node++) {
         int label = getLabelOfNode(node);
-        const std::vector<int>& neighbors = getNeighborsOfNode(node);
+        std::span<const int> neighbors = getNeighborsOfNode(node);
         std::cout << "node: " << label << " neighbors: " << neighbors.size() << " [ ";
         for (const int neighbor : neighbors)
             std::cout << getLabelOfNode(neighbor) << " ";
@@ -55,94 +55,118 @@ const std::vector<Component>& BiconnectedComponentsHandler::getComponents() cons
 }
 
 // assumes each edge node is in nodes list
-const Component BiconnectedComponentsHandler::buildComponent(std::list<int>& nodes, std::list<std::pair<int, int>>& edges) {
-    Component component(nodes.size(), originalGraph_m);
-    int oldToNewNodes[originalGraph_m.size()];
+// the component is built directly inside components_m
+void BiconnectedComponentsHandler::buildComponent(std::span<const int> nodes,
+        std::span<const std::pair<int, int>> edges) {
+    std::vector<int>& oldToNewNodes = workspace_m.nodeMap;
+    GraphBuilder builder(nodes.size());
+    builder.reserve(2*edges.size());
     int index = 0;
-    for (const int node : nodes) {
-        oldToNewNodes[node] = index;
-        component.assignNodeLabel(index, node);
-        ++index;
-    }
+    for (const int node : nodes)
+        oldToNewNodes[node] = index++;
     for (const std::pair<int, int>& edge: edges) {
         int from = oldToNewNodes[edge.first];
         int to = oldToNewNodes[edge.second];
-        component.addEdge(from, to);
+        builder.addEdge(from, to);
     }
-    return component;
+    components_m.emplace_back(builder, originalGraph_m);
+    Component& component = components_m.back();
+    index = 0;
+    for (const int node : nodes)
+        component.assignNodeLabel(index++, node);
 }
 
-
-void BiconnectedComponentsHandler::dfsBicCom(int node, int nodeId[], int prevOfNode[], int& nextIdToAssign, int lowPoint[],
-        std::list<int>& stackOfNodes, std::list<std::pair<int, int>>& stackOfEdges) {
-    nodeId[node] = nextIdToAssign;
-    lowPoint[node] = nextIdToAssign;
+// iterative version of the Hopcroft-Tarjan visit: the vertex stack and the edge stack
+// are shared by the whole visit, when the subtree of a node closes a component,
+// the component is made of everything above the node (and above its tree edge)
+void BiconnectedComponentsHandler::dfsBicCom(int root, std::vector<int>& nodeId, std::vector<int>& prevOfNode,
+        int& nextIdToAssign, std::vector<int>& lowPoint, std::vector<int>& nextNeighborIndex,
+        std::vector<int>& dfsStack, std::vector<int>& stackOfNodes, std::vector<std::pair<int, int>>& stackOfEdges) {
+    nodeId[root] = nextIdToAssign;
+    lowPoint[root] = nextIdToAssign;
     ++nextIdToAssign;
     int childrenNumber = 0;
-    for (const int neighbor : originalGraph_m.getNeighborsOfNode(node)) {
-        if (prevOfNode[node] == neighbor)
-            continue;
-        if (nodeId[neighbor] == -1) { // means node is not visited
-            std::list<int> newStackOfNodes{};
-            std::list<std::pair<int, int>> newStackOfEdges{};
-            ++childrenNumber;
-            prevOfNode[neighbor] = node;
-            newStackOfNodes.push_back(neighbor);
-            newStackOfEdges.push_back(std::make_pair(node, neighbor));
-            dfsBicCom(neighbor, nodeId, prevOfNode, nextIdToAssign, lowPoint, newStackOfNodes, newStackOfEdges);
-            if (lowPoint[neighbor] < lowPoint[node])
-                lowPoint[node] = lowPoint[neighbor];
-            if (lowPoint[neighbor] >= nodeId[node]) {
-                newStackOfNodes.push_back(node);
-                components_m.push_back(buildComponent(newStackOfNodes, newStackOfEdges));
-                if (prevOfNode[node] != -1) // the root needs to be handled differently
-                    // (handled at end of function)
-                    isCutVertex_m[node] = true;
+    dfsStack.push_back(root);
+    while (dfsStack.size() > 0) {
+        int node = dfsStack.back();
+        std::span<const int> neighbors = originalGraph_m.getNeighborsOfNode(node);
+        if (nextNeighborIndex[node] < neighbors.size()) {
+            int neighbor = neighbors[nextNeighborIndex[node]++];
+            if (prevOfNode[node] == neighbor)
+                continue;
+            if (nodeId[neighbor] == -1) { // means node is not visited
+                if (node == root) ++childrenNumber;
+                prevOfNode[neighbor] = node;
+                nodeId[neighbor] = nextIdToAssign;
+                lowPoint[neighbor] = nextIdToAssign;
+                ++nextIdToAssign;
+                stackOfNodes.push_back(neighbor);
+                stackOfEdges.push_back(std::make_pair(node, neighbor));
+                dfsStack.push_back(neighbor);
             }
-            else {
-                stackOfNodes.splice(stackOfNodes.end(), newStackOfNodes);
-                stackOfEdges.splice(stackOfEdges.end(), newStackOfEdges);
+            else { // node got already visited
+                int neighborNodeId = nodeId[neighbor];
+                if (neighborNodeId < nodeId[node]) {
+                    stackOfEdges.push_back(std::make_pair(node, neighbor));
+                    if (neighborNodeId < lowPoint[node])
+                        lowPoint[node] = neighborNodeId;
+                }
             }
+            continue;
         }
-        else { // node got already visited
-            int neighborNodeId = nodeId[neighbor];
-            if (neighborNodeId < nodeId[node]) {
-                stackOfEdges.push_back(std::make_pair(node, neighbor));
-                if (neighborNodeId < lowPoint[node])
-                    lowPoint[node] = neighborNodeId;
-            }
+        // all neighbors of node are visited, going back to its parent
+        dfsStack.pop_back();
+        if (node == root) break;
+        int parent = prevOfNode[node];
+        if (lowPoint[node] < lowPoint[parent])
+            lowPoint[parent] = lowPoint[node];
+        if (lowPoint[node] >= nodeId[parent]) {
+            // stacks hold: ... node [descendants of node] and ... (parent, node) [edges of the subtree]
+            int firstNode = stackOfNodes.size()-1;
+            while (stackOfNodes[firstNode] != node)
+                --firstNode;
+            int firstEdge = stackOfEdges.size()-1;
+            while (stackOfEdges[firstEdge].first != parent || stackOfEdges[firstEdge].second != node)
+                --firstEdge;
+            stackOfNodes.push_back(parent);
+            std::span<const int> nodes(stackOfNodes.data()+firstNode, stackOfNodes.size()-firstNode);
+            std::span<const std::pair<int, int>> edges(stackOfEdges.data()+firstEdge, stackOfEdges.size()-firstEdge);
+            buildComponent(nodes, edges);
+            stackOfNodes.resize(firstNode);
+            stackOfEdges.resize(firstEdge);
+            if (prevOfNode[parent] != -1) // the root needs to be handled differently
+                // (handled at end of function)
+                isCutVertex_m[parent] = true;
         }
     }
-    if (prevOfNode[node] == -1) { // handling of node with no parents (the root)
-        if (childrenNumber >= 2)
-            isCutVertex_m[node] = true;
-        else if (childrenNumber == 0) { // node is isolated
-            components_m.push_back(Component(1, originalGraph_m));
-            components_m.back().assignNodeLabel(0, node);
-        }
+    if (childrenNumber >= 2)
+        isCutVertex_m[root] = true;
+    else if (childrenNumber == 0) { // node is isolated
+        components_m.emplace_back(GraphBuilder(1), originalGraph_m);
+        components_m.back().assignNodeLabel(0, root);
     }
 }
 
-BiconnectedComponentsHandler::BiconnectedComponentsHandler(const MyGraph& graph) : originalGraph_m(graph) {
-    for (int i = 0; i < graph.size(); ++i)
-        isCutVertex_m.push_back(false);
-    int nodeId[graph.size()];
-    int prevOfNode[graph.size()];
-    int lowPoint[graph.size()];
-    for (int node = 0; node < graph.size(); ++node) {
-        nodeId[node] = -1;
-        prevOfNode[node] = -1;
-        lowPoint[node] = -1;
-    }
+BiconnectedComponentsHandler::BiconnectedComponentsHandler(const MyGraph& graph, EmbedderWorkspace& workspace)
+: originalGraph_m(graph), workspace_m(workspace) {
+    isCutVertex_m.assign(graph.size(), false);
+    workspace_m.reserveNodes(graph.size());
+    // the buffers keep their capacity, assign does not allocate once they are big enough
+    std::vector<int>& nodeId = workspace_m.nodeId;
+    std::vector<int>& prevOfNode = workspace_m.prevOfNode;
+    std::vector<int>& lowPoint = workspace_m.lowPoint;
+    std::vector<int>& nextNeighborIndex = workspace_m.nextNeighborIndex;
+    nodeId.assign(graph.size(), -1);
+    prevOfNode.assign(graph.size(), -1);
+    lowPoint.assign(graph.size(), -1);
+    nextNeighborIndex.assign(graph.size(), 0);
     int nextIdToAssign = 0;
-    std::list<int> stackOfNodes{}; // its better to use lists instead of vectors since
-    // we need to merge lists together (O(1) with lists, O(N) with vectors)
-    std::list<std::pair<int, int>> stackOfEdges{}; // same arguments
     for (int node = 0; node < graph.size(); node++)
         if (nodeId[node] == -1) // node not visited
-            dfsBicCom(node, nodeId, prevOfNode, nextIdToAssign, lowPoint, stackOfNodes, stackOfEdges);
-    assert(stackOfNodes.size() == 0);
-    assert(stackOfEdges.size() == 0);
+            dfsBicCom(node, nodeId, prevOfNode, nextIdToAssign, lowPoint, nextNeighborIndex,
+                workspace_m.dfsStack, workspace_m.stackOfNodes, workspace_m.stackOfEdges);
+    assert(workspace_m.stackOfNodes.size() == 0);
+    assert(workspace_m.stackOfEdges.size() == 0);
     for (int node = 0; node < graph.size(); ++node)
         if (isCutVertex_m[node]) cutVertices_m.push_back(node);
 }
\ No newline at end of file
@@ -2,10 +2,11 @@
 #define MY_BICONNECTED_COMPONENT_H
 
 #include <vector>
-#include <list>
+#include <span>
 #include <utility>
 
 #include "graph.hpp"
+#include "workspace.hpp"
 
 class Component : public MyGraph {
 private:
@@ -13,7 +14,7 @@ private:
     std::vector<int> nodeLabel_m{};
 
 public:
-    Component(int numberOfNodes, const MyGraph& graph);
+    Component(const GraphBuilder& builder, const MyGraph& graph);
 
     void print() const override;
     int getLabelOfNode(int node) const;
@@ -28,13 +29,15 @@ private:
     std::vector<bool> isCutVertex_m{};
     std::vector<int> cutVertices_m{};
     std::vector<Component> components_m{};
+    EmbedderWorkspace& workspace_m;
 
-    void dfsBicCom(int node, int nodeId[], int prevOfNode[], int& nextIdToAssign, int lowPoint[],
-        std::list<int>& nodes, std::list<std::pair<int, int>>& edges);
-    const Component buildComponent(std::list<int>& nodes, std::list<std::pair<int, int>>& edges);
+    void dfsBicCom(int root, std::vector<int>& nodeId, std::vector<int>& prevOfNode, int& nextIdToAssign,
+        std::vector<int>& lowPoint, std::vector<int>& nextNeighborIndex, std::vector<int>& dfsStack,
+        std::vector<int>& stackOfNodes, std::vector<std::pair<int, int>>& stackOfEdges);
+    void buildComponent(std::span<const int> nodes, std::span<const std::pair<int, int>> edges);
 
 public:
-    BiconnectedComponentsHandler(const MyGraph& graph);
+    BiconnectedComponentsHandler(const MyGraph& graph, EmbedderWorkspace& workspace);
 
     void print() const;
     const std::vector<Component>& getComponents() const;
@@ -0,0 +1,104 @@
+#include "binaryGraph.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <bit>
+#include <vector>
+
+#include "graph.hpp"
+#include "mappedFile.hpp"
+
+static_assert(std::endian::native == std::endian::little, "binary graphs are little endian");
+static_assert(sizeof(BinaryGraphHeader) == 40);
+
+namespace {
+    // neighbors of each node sorted, by a counting sort on the sources of the half edges (the
+    // transpose of a graph, which is the graph itself if it is symmetric)
+    std::vector<int> transpose(std::span<const int> offsets, std::span<const int> neighbors) {
+        std::vector<int> next(offsets.begin(), offsets.end()-1);
+        std::vector<int> transposed(neighbors.size());
+        for (int node = 0; node+1 < offsets.size(); ++node)
+            for (int i = offsets[node]; i < offsets[node+1]; ++i) {
+                if (next[neighbors[i]] == offsets[neighbors[i]+1]) return {};
+                transposed[next[neighbors[i]]++] = node;
+            }
+        return transposed;
+    }
+
+    // every half edge u->v has a v->u (as many times): the transpose is the graph with its
+    // neighbors sorted, which is the transpose of the transpose
+    bool isSymmetric(std::span<const int> offsets, std::span<const int> neighbors) {
+        std::vector<int> transposed = transpose(offsets, neighbors);
+        if (transposed.size() != neighbors.size()) return false;
+        return transpose(offsets, transposed) == transposed;
+    }
+}
+
+bool hasBinaryGraphMagic(const char* data, size_t size) {
+    return size >= sizeof(binaryGraphMagic) && std::memcmp(data, binaryGraphMagic, sizeof(binaryGraphMagic)) == 0;
+}
+
+uint64_t computeChecksum(std::span<const int> values, uint64_t hash) {
+    for (int value : values)
+        hash = (hash ^ uint32_t(value))*0x100000001b3;
+    return hash;
+}
+
+bool saveBinaryGraph(const MyGraph& graph, const char* path) {
+    std::span<const int> offsets = graph.getOffsets();
+    std::span<const int> neighbors = graph.getNeighbors();
+    BinaryGraphHeader header{};
+    std::memcpy(header.magic, binaryGraphMagic, sizeof(binaryGraphMagic));
+    header.version = binaryGraphVersion;
+    header.headerSize = sizeof(BinaryGraphHeader);
+    header.numberOfNodes = graph.size();
+    header.numberOfHalfEdges = neighbors.size();
+    header.checksum = computeChecksum(neighbors, computeChecksum(offsets));
+    std::ofstream output(path, std::ios::binary);
+    if (!output.is_open()) return false;
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(offsets.data()), offsets.size_bytes());
+    output.write(reinterpret_cast<const char*>(neighbors.data()), neighbors.size_bytes());
+    return output.good();
+}
+
+const char* checkBinaryGraph(const MappedFile& file, bool verify) {
+    if (file.size() < sizeof(BinaryGraphHeader) || !hasBinaryGraphMagic(file.data(), file.size()))
+        return "Not a binary graph file";
+    BinaryGraphHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.version != binaryGraphVersion) return "Unsupported binary graph version in file";
+    if (header.headerSize != sizeof(BinaryGraphHeader)) return "Wrong header size in file";
+    if (header.numberOfNodes >= INT32_MAX || header.numberOfHalfEdges > INT32_MAX)
+        return "Graph too big in file";
+    size_t arraysSize = (header.numberOfNodes+1+header.numberOfHalfEdges)*sizeof(int);
+    if (file.size() != header.headerSize+arraysSize) return "Wrong size of file";
+    const int* offsets = reinterpret_cast<const int*>(file.data()+header.headerSize);
+    const int* neighbors = offsets+header.numberOfNodes+1;
+    if (offsets[0] != 0 || offsets[header.numberOfNodes] != header.numberOfHalfEdges)
+        return "Wrong offsets in file";
+    // much cheaper than embedding the graph, and what keeps it from reading out of the arrays
+    for (uint64_t node = 0; node < header.numberOfNodes; ++node)
+        if (offsets[node] > offsets[node+1]) return "Wrong offsets in file";
+    for (uint64_t i = 0; i < header.numberOfHalfEdges; ++i)
+        if (neighbors[i] < 0 || neighbors[i] >= int(header.numberOfNodes)) return "Node out of range in file";
+    if (!verify) return nullptr;
+    std::span<const int> arrays(offsets, header.numberOfNodes+1+header.numberOfHalfEdges);
+    if (computeChecksum(arrays) != header.checksum) return "Wrong checksum in file";
+    std::span<const int> offsetsView(offsets, header.numberOfNodes+1);
+    std::span<const int> neighborsView(neighbors, header.numberOfHalfEdges);
+    if (!isSymmetric(offsetsView, neighborsView)) return "Edge without its opposite half in file";
+    return nullptr;
+}
+
+MyGraph viewBinaryGraph(std::shared_ptr<const MappedFile> file) {
+    assert(checkBinaryGraph(*file, false) == nullptr);
+    BinaryGraphHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    const int* offsets = reinterpret_cast<const int*>(file->data()+header.headerSize);
+    std::span<const int> offsetsView(offsets, header.numberOfNodes+1);
+    std::span<const int> neighborsView(offsets+header.numberOfNodes+1, header.numberOfHalfEdges);
+    const MappedFile* data = file.get();
+    return MyGraph(header.numberOfNodes, offsetsView, neighborsView, std::shared_ptr<const void>(std::move(file), data));
+}
\ No newline at end of file
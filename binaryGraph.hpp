@@ -0,0 +1,38 @@
+#ifndef MY_BINARY_GRAPH_H
+#define MY_BINARY_GRAPH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+class MyGraph;
+class MappedFile;
+
+// binary graph file (native little endian): a BinaryGraphHeader, then the CSR arrays of
+// the graph as 32 bit integers, the offsets (numberOfNodes+1) and the neighbors (numberOfHalfEdges)
+struct BinaryGraphHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t numberOfNodes;
+    uint64_t numberOfHalfEdges;
+    uint64_t checksum; // of the two arrays, offsets first
+};
+
+constexpr char binaryGraphMagic[8] = {'M', 'Y', 'G', 'R', 'A', 'P', 'H', '\0'};
+constexpr uint32_t binaryGraphVersion = 1;
+
+bool hasBinaryGraphMagic(const char* data, size_t size);
+// FNV-1a on 32 bit words, hash is the result for the values before (to chain calls)
+uint64_t computeChecksum(std::span<const int> values, uint64_t hash = 0xcbf29ce484222325);
+// false if the file cannot be written
+bool saveBinaryGraph(const MyGraph& graph, const char* path);
+// checks the header against the file size, that the offsets go up from 0 to the number of half
+// edges and that the neighbors are nodes; with verify also the checksum and that each half edge
+// has its opposite one: nullptr if valid, else what is wrong
+const char* checkBinaryGraph(const MappedFile& file, bool verify);
+// graph using the arrays in the (checked) file directly, the file stays mapped while it is used
+MyGraph viewBinaryGraph(std::shared_ptr<const MappedFile> file);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "bufferedWriter.hpp"
+
+#include <cstring>
+#include <charconv>
+
+BufferedWriter::BufferedWriter(const char* path) : file_m(std::fopen(path, "wb")), buffer_m(bufferSize), isGood_m(file_m != nullptr) {}
+
+BufferedWriter::~BufferedWriter() {
+    if (file_m != nullptr) std::fclose(file_m);
+}
+
+bool BufferedWriter::isGood() const {
+    return isGood_m;
+}
+
+void BufferedWriter::flush() {
+    if (isGood_m && used_m > 0 && std::fwrite(buffer_m.data(), 1, used_m, file_m) != used_m)
+        isGood_m = false;
+    used_m = 0;
+}
+
+char* BufferedWriter::reserve() {
+    if (used_m+maxNumberSize > buffer_m.size()) flush();
+    return buffer_m.data()+used_m;
+}
+
+void BufferedWriter::commit(char* end) {
+    used_m = end-buffer_m.data();
+}
+
+// data bigger than the buffer is written directly
+void BufferedWriter::writeBytes(const void* data, size_t size) {
+    if (used_m+size > buffer_m.size()) flush();
+    if (size > buffer_m.size()) {
+        if (isGood_m && std::fwrite(data, 1, size, file_m) != size) isGood_m = false;
+        return;
+    }
+    std::memcpy(buffer_m.data()+used_m, data, size);
+    used_m += size;
+}
+
+void BufferedWriter::writeText(std::string_view text) {
+    writeBytes(text.data(), text.size());
+}
+
+void BufferedWriter::writeNumber(int64_t value, char separator) {
+    char* cursor = reserve();
+    cursor = std::to_chars(cursor, cursor+maxNumberSize-1, value).ptr;
+    *cursor++ = separator;
+    commit(cursor);
+}
+
+void BufferedWriter::writeVarint(uint64_t value) {
+    char* cursor = reserve();
+    while (value >= 0x80) {
+        *cursor++ = char(value | 0x80);
+        value >>= 7;
+    }
+    *cursor++ = char(value);
+    commit(cursor);
+}
+
+void BufferedWriter::writeAtStart(const void* data, size_t size) {
+    flush();
+    if (isGood_m && std::fseek(file_m, 0, SEEK_SET) != 0) isGood_m = false;
+    if (isGood_m && std::fwrite(data, 1, size, file_m) != size) isGood_m = false;
+}
+
+bool BufferedWriter::close() {
+    flush();
+    if (file_m != nullptr && std::fclose(file_m) != 0) isGood_m = false;
+    file_m = nullptr;
+    return isGood_m;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef MY_BUFFERED_WRITER_H
+#define MY_BUFFERED_WRITER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include <string_view>
+
+// output file written through a fixed buffer, for files much bigger than what should be
+// kept in memory; errors are remembered and reported by close
+class BufferedWriter {
+private:
+    static constexpr size_t bufferSize = 1 << 20;
+    // enough for any single number written at once
+    static constexpr size_t maxNumberSize = 24;
+
+    std::FILE* file_m;
+    std::vector<char> buffer_m;
+    size_t used_m{0};
+    bool isGood_m;
+
+    // room for one more number
+    char* reserve();
+    void commit(char* end);
+
+public:
+    BufferedWriter(const char* path);
+    ~BufferedWriter();
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    bool isGood() const;
+    void flush();
+    void writeBytes(const void* data, size_t size);
+    void writeText(std::string_view text);
+    // in decimal, followed by separator
+    void writeNumber(int64_t value, char separator);
+    // LEB128
+    void writeVarint(uint64_t value);
+    // rewrites the start of the file, everything written so far is flushed first
+    void writeAtStart(const void* data, size_t size);
+    // closes the file, false if anything could not be written
+    bool close();
+};
+
+#endif
\ No newline at end of file
@@ -1,12 +1,43 @@
-g++ -o main \
-    -IOGDF/include \
-    -LOGDF \
-    main.cpp \
-    graph.cpp \
+SOURCES="graph.cpp \
     biconnectedComponent.cpp \
     segment.cpp \
     cycle.cpp \
     graphLoader.cpp \
+    mappedFile.cpp \
+    binaryGraph.cpp \
     interlacement.cpp \
     embedder.cpp \
-    -lOGDF -lCOIN
\ No newline at end of file
+    workspace.cpp \
+    threadPool.cpp \
+    planarityFilter.cpp \
+    embedderStats.cpp \
+    kuratowski.cpp \
+    dartIndex.cpp \
+    incrementalEmbedder.cpp \
+    bufferedWriter.cpp \
+    embeddingWriter.cpp \
+    planarDrawing.cpp \
+    embeddingSvg.cpp \
+    resultCache.cpp \
+    smallGraphEmbedder.cpp \
+    seriesReduction.cpp"
+# OGDF is only used for its svg layout (--ogdf-layout): WITHOUT_OGDF=1 ./compile.sh builds without it
+if [ "$WITHOUT_OGDF" = 1 ]; then
+    OGDF_FLAGS="-DMY_WITHOUT_OGDF"
+    OGDF_LIBS=""
+else
+    OGDF_FLAGS="-IOGDF/include -LOGDF"
+    OGDF_LIBS="-lOGDF -lCOIN"
+fi
+g++ -std=c++20 -pthread -o main \
+    $OGDF_FLAGS \
+    main.cpp \
+    batch.cpp \
+    $SOURCES \
+    $OGDF_LIBS
+g++ -std=c++20 -O2 -pthread -o benchmark \
+    $OGDF_FLAGS \
+    benchmark.cpp \
+    graphGenerator.cpp \
+    $SOURCES \
+    $OGDF_LIBS
\ No newline at end of file
@@ -4,18 +4,27 @@
 
 #include "utils.hpp"
 
-void Cycle::dfsBuildCycle(int node, bool isNodeVisited[], int prev) {
-    nodes_m.push_back(node);
-    isNodeVisited[node] = true;
-    for (const int neighbor : originalComponent_m.getNeighborsOfNode(node)) {
-        if (neighbor == prev)
-            continue;
-        if (!isNodeVisited[neighbor]) {
-            dfsBuildCycle(neighbor, isNodeVisited, node);
-            break;
+// walks from node (always moving to the first neighbor other than the one it came from)
+// until it reaches an already visited node, which closes the cycle
+void Cycle::dfsBuildCycle(int node, EpochMarker& isNodeVisited) {
+    int prev = -1;
+    while (true) {
+        nodes_m.push_back(node);
+        isNodeVisited.mark(node);
+        int next = -1;
+        for (const int neighbor : originalComponent_m.getNeighborsOfNode(node)) {
+            if (neighbor == prev)
+                continue;
+            if (!isNodeVisited.isMarked(neighbor)) {
+                next = neighbor;
+                break;
+            }
+            nodes_m.push_back(neighbor);
+            return;
         }
-        nodes_m.push_back(neighbor);
-        return;
+        if (next == -1) return;
+        prev = node;
+        node = next;
     }
 }
 
@@ -32,11 +41,9 @@ void Cycle::cleanupCycle() {
     }
 }
 
-Cycle::Cycle(const Component& component) : originalComponent_m(component) {
-    bool isNodeVisited[component.size()];
-    for (int node = 0; node < component.size(); ++node)
-        isNodeVisited[node] = false;
-    dfsBuildCycle(0, isNodeVisited, -1);
+Cycle::Cycle(const Component& component, EmbedderWorkspace& workspace) : originalComponent_m(component) {
+    workspace.visited.reset(component.size());
+    dfsBuildCycle(0, workspace.visited);
     cleanupCycle();
     posInCycle_m.resize(component.size());
     for (int i = 0; i < component.size(); ++i)
@@ -48,44 +55,38 @@ Cycle::Cycle(const Component& component) : originalComponent_m(component) {
     }
 }
 
-// if nodeToInclude is -1 it is just ignored
-void Cycle::changeWithPath(std::list<int>& path, int nodeToInclude) {
-    std::list<int> nodesCopy(path); // newCycleList
-    int firstOfPath = path.front();
-    int lastOfPath = path.back();
-    int i = 0;
-    while (nodes_m[i] != lastOfPath)
-        nextIndex(i);
-    nextIndex(i);
-    if (nodeToInclude != -1) {
-        bool foundNodeToInclude = false;
-        while (nodes_m[i] != firstOfPath) {
-            if (nodes_m[i] == nodeToInclude) foundNodeToInclude = true;
-            nodesCopy.push_back(nodes_m[i]);
-            nextIndex(i);
-        }
-        if (!foundNodeToInclude) { // cycle needs to be reversed
-            reverse();
-            changeWithPath(path, nodeToInclude);
-            return;
-        }
-    }
-    else {
-        while (nodes_m[i] != firstOfPath) {
-            nodesCopy.push_back(nodes_m[i]);
-            nextIndex(i);
-        }
-    }
-    nodes_m.clear();
-    for (int i = 0; i < posInCycle_m.size(); ++i)
-        posInCycle_m[i] = -1;
-    i = 0;
-    while (nodesCopy.size() > 0) {
-        nodes_m.push_back(nodesCopy.back());
-        posInCycle_m[nodesCopy.back()] = i;
-        nodesCopy.pop_back();
-        ++i;
+// path goes from a node of the cycle to another one through nodes not in the cycle: it replaces
+// the arc from its last node to its first one that does not contain nodeToInclude (if nodeToInclude
+// is -1, the arc from its first node to its last one). the new cycle is the rest of the cycle
+// walked backwards from the first node of path, then path walked backwards. the nodes that leave
+// the cycle are appended to removedNodes
+void Cycle::changeWithPath(const std::vector<int>& path, int nodeToInclude, std::vector<int>& removedNodes) {
+    assert(path.size() >= 2);
+    int firstOfPath = posInCycle_m[path.front()];
+    int lastOfPath = posInCycle_m[path.back()];
+    assert(firstOfPath != -1 && lastOfPath != -1);
+    // the arc kept goes forward from lastOfPath to firstOfPath
+    auto distance = [&](int from, int to) {
+        return (to-from+size()) % size();
+    };
+    if (nodeToInclude != -1 && distance(lastOfPath, posInCycle_m[nodeToInclude]) > distance(lastOfPath, firstOfPath)) {
+        reverse();
+        firstOfPath = posInCycle_m[path.front()];
+        lastOfPath = posInCycle_m[path.back()];
     }
+    for (int i = firstOfPath; (i = (i+1) % size()) != lastOfPath; )
+        removedNodes.push_back(nodes_m[i]);
+    std::vector<int> newNodes{};
+    newNodes.reserve(size()-distance(firstOfPath, lastOfPath)+path.size()-1);
+    for (int i = firstOfPath; (i = (i+size()-1) % size()) != lastOfPath; )
+        newNodes.push_back(nodes_m[i]);
+    for (int i = path.size()-1; i >= 0; --i)
+        newNodes.push_back(path[i]);
+    for (const int node : nodes_m)
+        posInCycle_m[node] = -1;
+    nodes_m = std::move(newNodes);
+    for (int i = 0; i < nodes_m.size(); ++i)
+        posInCycle_m[nodes_m[i]] = i;
 }
 
 bool Cycle::hasNode(int node) const {
@@ -110,11 +111,6 @@ int Cycle::getNextOfNode(int node) const {
     return nodes_m[pos+1];
 }
 
-void Cycle::nextIndex(int& index) {
-    ++index;
-    index %= nodes_m.size();
-}
-
 const std::vector<int>& Cycle::nodes() const {
     return nodes_m;
 }
@@ -2,10 +2,10 @@
 #define MY_CYCLE_H
 
 #include <vector>
-#include <list>
 #include <optional>
 
 #include "biconnectedComponent.hpp"
+#include "workspace.hpp"
 
 class Cycle {
 private:
@@ -13,14 +13,13 @@ private:
     std::vector<int> posInCycle_m{};
     const Component& originalComponent_m;
 
-    void dfsBuildCycle(int node, bool isNodeVisited[], int prev);
+    void dfsBuildCycle(int node, EpochMarker& isNodeVisited);
     void cleanupCycle();
-    void nextIndex(int& index);
 
 public:
-    Cycle(const Component& component);
+    Cycle(const Component& component, EmbedderWorkspace& workspace);
 
-    void changeWithPath(std::list<int>& path, int nodeToInclude);
+    void changeWithPath(const std::vector<int>& path, int nodeToInclude, std::vector<int>& removedNodes);
     bool hasNode(int node) const;
     int size() const;
     int getPrevOfNode(int node) const;
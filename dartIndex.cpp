@@ -0,0 +1,158 @@
+#include "dartIndex.hpp"
+
+#include <cassert>
+
+#include "embedder.hpp"
+
+DartIndex::DartIndex(const Embedding& embedding) : embedding_m(embedding) {
+    computeTwins();
+    computeFaces();
+}
+
+// darts are grouped by their head (counting sort), then the darts entering each node
+// are matched with the ones leaving it through an array indexed by the other end
+void DartIndex::computeTwins() {
+    std::span<const int> offsets = embedding_m.getOffsets();
+    std::span<const int> heads = embedding_m.getNeighbors();
+    int numberOfNodes = embedding_m.size();
+    tail_m.resize(heads.size());
+    for (int node = 0; node < numberOfNodes; ++node)
+        for (int dart = offsets[node]; dart < offsets[node+1]; ++dart)
+            tail_m[dart] = node;
+    std::vector<int> incomingOffsets(numberOfNodes+1, 0);
+    for (int head : heads)
+        ++incomingOffsets[head+1];
+    for (int node = 0; node < numberOfNodes; ++node)
+        incomingOffsets[node+1] += incomingOffsets[node];
+    std::vector<int> incoming(heads.size());
+    std::vector<int> insertionPoint(incomingOffsets.begin(), incomingOffsets.end()-1);
+    for (int dart = 0; dart < heads.size(); ++dart)
+        incoming[insertionPoint[heads[dart]]++] = dart;
+    std::vector<int> dartTo(numberOfNodes, -1);
+    twin_m.assign(heads.size(), -1);
+    for (int node = 0; node < numberOfNodes; ++node) {
+        for (int dart = offsets[node]; dart < offsets[node+1]; ++dart)
+            dartTo[heads[dart]] = dart;
+        for (int i = incomingOffsets[node]; i < incomingOffsets[node+1]; ++i)
+            twin_m[incoming[i]] = dartTo[tail_m[incoming[i]]];
+        for (int dart = offsets[node]; dart < offsets[node+1]; ++dart)
+            dartTo[heads[dart]] = -1;
+    }
+    for (int twin : twin_m)
+        assert(twin != -1);
+}
+
+void DartIndex::computeFaces() {
+    std::span<const int> offsets = embedding_m.getOffsets();
+    next_m.resize(twin_m.size());
+    for (int dart = 0; dart < twin_m.size(); ++dart) {
+        int twin = twin_m[dart];
+        int head = tail_m[twin];
+        next_m[dart] = twin+1 < offsets[head+1] ? twin+1 : offsets[head];
+    }
+    face_m.assign(twin_m.size(), -1);
+    faceOffsets_m.assign(1, 0);
+    faceDarts_m.reserve(twin_m.size());
+    for (int dart = 0; dart < twin_m.size(); ++dart) {
+        if (face_m[dart] != -1) continue;
+        int face = faceOffsets_m.size()-1;
+        for (int current = dart; face_m[current] == -1; current = next_m[current]) {
+            face_m[current] = face;
+            faceDarts_m.push_back(current);
+        }
+        faceOffsets_m.push_back(faceDarts_m.size());
+    }
+}
+
+int DartIndex::numberOfDarts() const {
+    return twin_m.size();
+}
+
+int DartIndex::getTail(int dart) const {
+    return tail_m[dart];
+}
+
+int DartIndex::getHead(int dart) const {
+    return embedding_m.getNeighbors()[dart];
+}
+
+int DartIndex::getTwin(int dart) const {
+    return twin_m[dart];
+}
+
+int DartIndex::getNext(int dart) const {
+    return next_m[dart];
+}
+
+int DartIndex::getFace(int dart) const {
+    return face_m[dart];
+}
+
+int DartIndex::numberOfFaces() const {
+    return faceOffsets_m.size()-1;
+}
+
+std::span<const int> DartIndex::getDartsOfFace(int face) const {
+    return std::span<const int>(faceDarts_m).subspan(faceOffsets_m[face], faceOffsets_m[face+1]-faceOffsets_m[face]);
+}
+
+int DartIndex::getFaceSize(int face) const {
+    return faceOffsets_m[face+1]-faceOffsets_m[face];
+}
+
+Embedding DartIndex::computeDual() const {
+    GraphBuilder dual(numberOfFaces());
+    dual.reserve(faceDarts_m.size());
+    for (int face = 0; face < numberOfFaces(); ++face)
+        for (int dart : getDartsOfFace(face))
+            dual.addSingleEdge(face, face_m[twin_m[dart]]);
+    return Embedding(dual);
+}
+
+// each component with edges traces its own outer face, an isolated node traces none:
+// with F the traced faces and I the isolated nodes the formula becomes V - E + F = 2C - I
+const char* DartIndex::checkEulerFormula() const {
+    int numberOfNodes = embedding_m.size();
+    std::vector<bool> isReached(numberOfNodes, false);
+    std::vector<int> queue{};
+    long long numberOfComponents = 0;
+    long long numberOfIsolatedNodes = 0;
+    for (int root = 0; root < numberOfNodes; ++root) {
+        if (isReached[root]) continue;
+        ++numberOfComponents;
+        if (embedding_m.getNeighborsOfNode(root).empty()) ++numberOfIsolatedNodes;
+        isReached[root] = true;
+        queue.assign(1, root);
+        for (int head = 0; head < queue.size(); ++head) {
+            for (int neighbor : embedding_m.getNeighborsOfNode(queue[head])) {
+                if (isReached[neighbor]) continue;
+                isReached[neighbor] = true;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+    long long euler = numberOfNodes-(long long)(numberOfDarts()/2)+numberOfFaces();
+    if (euler != 2*numberOfComponents-numberOfIsolatedNodes) return "Euler formula does not hold, the rotations are not planar";
+    return nullptr;
+}
+
+// neighbors of each node are marked with node+1 in the graph, then with -(node+1) once met
+// in the embedding: same degrees and no repeated neighbors make the neighbor sets equal
+const char* checkEmbedding(const MyGraph& graph, const Embedding& embedding) {
+    if (graph.size() != embedding.size()) return "different number of nodes";
+    std::vector<int> mark(graph.size(), 0);
+    for (int node = 0; node < graph.size(); ++node) {
+        std::span<const int> neighbors = graph.getNeighborsOfNode(node);
+        std::span<const int> rotation = embedding.getNeighborsOfNode(node);
+        if (neighbors.size() != rotation.size()) return "different degree of a node";
+        for (int neighbor : neighbors)
+            mark[neighbor] = node+1;
+        for (int neighbor : rotation) {
+            if (neighbor < 0 || neighbor >= graph.size()) return "node out of range";
+            if (mark[neighbor] == -(node+1)) return "repeated neighbor";
+            if (mark[neighbor] != node+1) return "edge not in the graph";
+            mark[neighbor] = -(node+1);
+        }
+    }
+    return DartIndex(embedding).checkEulerFormula();
+}
\ No newline at end of file
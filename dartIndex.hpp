@@ -0,0 +1,53 @@
+#ifndef MY_DART_INDEX_H
+#define MY_DART_INDEX_H
+
+#include <vector>
+#include <span>
+
+#include "graph.hpp"
+
+class Embedding;
+
+// half edges (darts) of an embedding: dart d is the d-th entry of the neighbor array, so it
+// goes from its tail to getNeighbors()[d] and the darts leaving a node are consecutive, in
+// rotation order; the next dart of a face is the one after the twin in the rotation of its head.
+// the embedding must be a rotation system of a simple graph (see checkEmbedding)
+class DartIndex {
+private:
+    const Embedding& embedding_m;
+    std::vector<int> tail_m{};
+    std::vector<int> twin_m{};
+    std::vector<int> next_m{};
+    std::vector<int> face_m{};
+    // darts of face f, in order: faceDarts_m[faceOffsets_m[f]] ... faceDarts_m[faceOffsets_m[f+1]-1]
+    std::vector<int> faceOffsets_m{};
+    std::vector<int> faceDarts_m{};
+
+    void computeTwins();
+    void computeFaces();
+
+public:
+    DartIndex(const Embedding& embedding);
+
+    int numberOfDarts() const;
+    int getTail(int dart) const;
+    int getHead(int dart) const;
+    int getTwin(int dart) const;
+    int getNext(int dart) const;
+    int getFace(int dart) const;
+    // every connected component with edges has its own outer face
+    int numberOfFaces() const;
+    std::span<const int> getDartsOfFace(int face) const;
+    int getFaceSize(int face) const;
+    // one node per face: the darts of the dual around face f cross, in order, the darts of
+    // getDartsOfFace(f), so the dual is embedded too; bridges give self loops and faces
+    // sharing more than one edge give parallel edges
+    Embedding computeDual() const;
+    // nullptr if V - E + F = 1 + C (outer faces counted once, C connected components)
+    const char* checkEulerFormula() const;
+};
+
+// linear time: nullptr if embedding is a planar embedding of graph, otherwise what is wrong
+const char* checkEmbedding(const MyGraph& graph, const Embedding& embedding);
+
+#endif
\ No newline at end of file
@@ -2,28 +2,25 @@
 
 #include <cassert>
 #include <iostream>
-
-#include <ogdf/basic/Graph.h>
-#include <ogdf/basic/GraphAttributes.h>
-#include <ogdf/planarlayout/PlanarStraightLayout.h>
-#include <ogdf/planarlayout/PlanarDrawLayout.h>
-#include <ogdf/fileformats/GraphIO.h>
-#include <ogdf/planarity/EmbedderModule.h>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
 
 #include "interlacement.hpp"
+#include "seriesReduction.hpp"
+#include "kuratowski.hpp"
 #include "utils.hpp"
+#include "resultCache.hpp"
+#include "smallGraphEmbedder.hpp"
 
-using namespace ogdf;
-
-Embedding::Embedding(int numberOfNodes) : MyGraph(numberOfNodes) {}
+Embedding::Embedding(const GraphBuilder& builder) : MyGraph(builder) {}
 
-void Embedding::addSingleEdge(int from, int to) {
-    neighborsOfNode_m[from].push_back(to);
-}
+Embedding::Embedding(MyGraph&& rotations) : MyGraph(std::move(rotations)) {}
 
 Embedding mergeBiconnectedComponents(const MyGraph& graph, const std::vector<Component>& components,
 const std::vector<std::optional<Embedding>>& embeddings) {
-    Embedding output(graph.size());
+    GraphBuilder output(graph.size());
+    output.reserve(2*graph.numberOfEdges());
     assert(components.size() == embeddings.size());
     for (int i = 0; i < components.size(); ++i) {
         assert(embeddings[i].has_value());
@@ -37,355 +34,620 @@ const std::vector<std::optional<Embedding>>& embeddings) {
             }
         }
     }
-    return output;
-}
-
-Graph myGraphToOgdf(const MyGraph& myGraph) {
-    Graph graph;
-    std::vector<node> nodes(myGraph.size());
-    for (int n = 0; n < myGraph.size(); ++n)
-        nodes[n] = graph.newNode();
-    for (int n = 0; n < myGraph.size(); ++n)
-        for (int neighbor : myGraph.getNeighborsOfNode(n))
-            if (n < neighbor)
-                graph.newEdge(nodes[n], nodes[neighbor]);
-    return graph;
-}
-
-Graph embeddingToOgdfGraph(const Embedding& embedding) {
-    Graph graph = myGraphToOgdf(embedding);
-    std::vector<int> position(embedding.size());
-    for (node n : graph.nodes) {
-        const int label = n->index();
-        const std::vector<int>& neighbors = embedding.getNeighborsOfNode(label);
-        for (int i = 0; i < neighbors.size(); ++i)
-            position[neighbors[i]] = i;
-        std::vector<adjEntry> order(neighbors.size());
-        for (adjEntry& adj : n->adjEntries) {
-            const int neighbor = adj->twinNode()->index();
-            order[position[neighbor]] = adj;
-        }
-        List<adjEntry> newOrder;
-        for (adjEntry& adj : order)
-            newOrder.pushBack(adj);
-        graph.sort(n, newOrder);
-    }
-    return graph;
+    return Embedding(output);
 }
 
-void Embedding::saveToSvg(std::string& outputPath) const {
-    Graph graph = embeddingToOgdfGraph(*this);
-    GraphAttributes GA(graph, GraphAttributes::nodeGraphics | GraphAttributes::edgeGraphics |
-                        GraphAttributes::nodeLabel | GraphAttributes::edgeStyle |
-                        GraphAttributes::nodeStyle | GraphAttributes::edgeArrow);
-    for (node v : graph.nodes) {
-        GA.label(v) = std::to_string(v->index());
-        GA.shape(v) = Shape::Ellipse;
+Embedder::Embedder(int numberOfThreads) {
+    assert(numberOfThreads > 0);
+    if (numberOfThreads == 1) return;
+    threadPool_m = std::make_unique<ThreadPool>(numberOfThreads);
+    for (int worker = 0; worker < numberOfThreads; ++worker) {
+        workers_m.push_back(std::make_unique<Embedder>());
+        workers_m.back()->master_m = this;
     }
-    for (edge e : graph.edges) {
-        GA.strokeWidth(e) = 1.5;
-        GA.arrowType(e) = EdgeArrow::None;
+}
+
+Embedder::~Embedder() = default;
+
+// null when statistics are disabled, so that PhaseTimers do nothing
+EmbedderStats* Embedder::activeStats() {
+    return isStatisticsEnabled_m ? &stats_m : nullptr;
+}
+
+Embedder& Embedder::owner() {
+    return master_m != nullptr ? *master_m : *this;
+}
+
+bool Embedder::isCancelled() const {
+    return master_m != nullptr && master_m->isNonPlanar_m.load(std::memory_order_relaxed);
+}
+
+void Embedder::cancel() {
+    if (master_m != nullptr)
+        master_m->isNonPlanar_m.store(true, std::memory_order_relaxed);
+}
+
+std::nullopt_t Embedder::reject(PlanarityFilter filter) {
+    PlanarityFilter none = PlanarityFilter::None;
+    owner().decidingFilter_m.compare_exchange_strong(none, filter);
+    cancel();
+    return std::nullopt;
+}
+
+PlanarityFilter Embedder::getDecidingFilter() const {
+    return decidingFilter_m.load();
+}
+
+void Embedder::setSeriesReduction(bool isEnabled) {
+    isSeriesReductionEnabled_m = isEnabled;
+}
+
+void Embedder::setSmallGraphEngine(bool isEnabled) {
+    isSmallGraphEngineEnabled_m = isEnabled;
+    for (std::unique_ptr<Embedder>& worker : workers_m)
+        worker->isSmallGraphEngineEnabled_m = isEnabled;
+}
+
+void Embedder::setStatistics(bool isEnabled) {
+    isStatisticsEnabled_m = isEnabled;
+    for (std::unique_ptr<Embedder>& worker : workers_m)
+        worker->isStatisticsEnabled_m = isEnabled;
+}
+
+const EmbedderStats& Embedder::getStatistics() const {
+    return stats_m;
+}
+
+void Embedder::setWitnessExtraction(bool isEnabled) {
+    isWitnessEnabled_m = isEnabled;
+    for (std::unique_ptr<Embedder>& worker : workers_m)
+        worker->isWitnessEnabled_m = isEnabled;
+}
+
+const std::vector<std::pair<int, int>>& Embedder::getWitness() const {
+    return witness_m;
+}
+
+void Embedder::setCache(ResultCache* cache) {
+    cache_m = cache;
+}
+
+bool Embedder::isLastResultCached() const {
+    return isLastResultCached_m;
+}
+
+// only the first failure is kept, the others come from tasks that were already running
+void Embedder::recordWitness(const Component& component, const Cycle& cycle, const std::vector<Segment>& segments,
+const MyGraph& interlacementGraph) {
+    Embedder& witnessOwner = owner();
+    {
+        std::lock_guard<std::mutex> lock(witnessOwner.witnessMutex_m);
+        if (witnessOwner.witnessGraph_m != nullptr) return;
     }
-    PlanarDrawLayout layout;
-    layout.call(GA);
-    GraphIO::write(GA, outputPath);
+    PhaseTimer timer(activeStats(), EmbedderPhase::Witness);
+    std::vector<std::pair<int, int>> witness = findKuratowskiSubdivision(component, cycle, segments, interlacementGraph);
+    std::lock_guard<std::mutex> lock(witnessOwner.witnessMutex_m);
+    if (witnessOwner.witnessGraph_m != nullptr) return;
+    witnessOwner.witness_m = std::move(witness);
+    witnessOwner.witnessGraph_m = &component;
 }
 
+// levels that did not lead to the recorded failure leave the witness alone
+void Embedder::liftWitnessFromSegment(const Segment& segment, const Component& component) {
+    Embedder& witnessOwner = owner();
+    std::lock_guard<std::mutex> lock(witnessOwner.witnessMutex_m);
+    if (witnessOwner.witnessGraph_m != &segment) return;
+    liftToOriginalComponent(segment, witnessOwner.witness_m);
+    witnessOwner.witnessGraph_m = &component;
+}
 
-std::optional<const Embedding> Embedder::embed(const MyGraph& graph) {
-    if (graph.size() < 4) return baseCaseGraph(graph);
-    const BiconnectedComponentsHandler bicComps(graph);
-    std::vector<std::optional<Embedding>> embeddings{};
-    for (const auto& component : bicComps.getComponents()) {
-        embeddings.push_back(embed(component));
-        if (!embeddings.back().has_value()) return std::nullopt;
+void Embedder::liftWitnessFromComponent(const Component& component, const MyGraph& graph) {
+    Embedder& witnessOwner = owner();
+    std::lock_guard<std::mutex> lock(witnessOwner.witnessMutex_m);
+    if (witnessOwner.witnessGraph_m != &component) return;
+    liftToOriginalGraph(component, witnessOwner.witness_m);
+    witnessOwner.witnessGraph_m = &graph;
+}
+
+std::optional<Embedding> Embedder::embed(const MyGraph& graph) {
+    isLastResultCached_m = false;
+    if (cache_m == nullptr || isWitnessEnabled_m) return embedUncached(graph);
+    const GraphHash hash = computeGraphHash(graph);
+    std::optional<CachedResult> cached = cache_m->find(graph, hash);
+    if (cached.has_value()) {
+        isLastResultCached_m = true;
+        decidingFilter_m.store(cached->filter);
+        stats_m.clear();
+        return std::move(cached->embedding);
     }
-    return mergeBiconnectedComponents(graph, bicComps.getComponents(), embeddings);
+    std::optional<Embedding> embedding = embedUncached(graph);
+    cache_m->store(graph, hash, embedding, getDecidingFilter());
+    return embedding;
 }
 
-// for each segment, it computes the minimum and the maximum of all of its attachments
-void Embedder::computeMinAndMaxSegmentsAttachments(const std::vector<Segment>& segments,
-int segmentsMinAttachment[], int segmentsMaxAttachment[]) {
-    for (int i = 0; i < segments.size(); i++) {
-        int min = segments[i].size();
-        int max = 0;
-        for (int attachment : segments[i].getAttachments()) {
-            if (attachment < min) min = attachment;
-            if (attachment > max) max = attachment;
+std::optional<Embedding> Embedder::embedUncached(const MyGraph& graph) {
+    decidingFilter_m.store(PlanarityFilter::None);
+    witnessGraph_m = nullptr;
+    witness_m.clear();
+    if (!isStatisticsEnabled_m) return reduceAndEmbed(graph);
+    stats_m.clear();
+    for (std::unique_ptr<Embedder>& worker : workers_m)
+        worker->stats_m.clear();
+    auto start = std::chrono::steady_clock::now();
+    std::optional<Embedding> embedding = reduceAndEmbed(graph);
+    for (const std::unique_ptr<Embedder>& worker : workers_m)
+        stats_m.add(worker->stats_m);
+    stats_m.totalMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+    return embedding;
+}
+
+std::optional<Embedding> Embedder::reduceAndEmbed(const MyGraph& graph) {
+    if (!isSeriesReductionEnabled_m || isSmallGraph(graph) || !SeriesReduction::hasNodesOfDegreeTwo(graph))
+        return embedGraph(graph);
+    PhaseTimer reductionTimer(activeStats(), EmbedderPhase::SeriesReduction);
+    const SeriesReduction reduction(graph);
+    reductionTimer.stop();
+    std::optional<Embedding> embedding = embedGraph(reduction.getReducedGraph());
+    if (!embedding.has_value()) {
+        if (witnessGraph_m == &reduction.getReducedGraph()) {
+            reduction.expandEdges(witness_m);
+            witnessGraph_m = &graph;
         }
-        segmentsMinAttachment[i] = min;
-        segmentsMaxAttachment[i] = max;
+        return std::nullopt;
     }
+    PhaseTimer expansionTimer(activeStats(), EmbedderPhase::SeriesExpansion);
+    return reduction.expand(embedding.value());
 }
 
-const std::vector<int> Embedder::computeOrder(int cycleNode, const std::vector<int>& segmentsIndexes,
-int segmentsMinAttachment[], int segmentsMaxAttachment[], const std::vector<Segment>& segments) {
-    std::optional<int> middleSegment;
-    std::vector<int> minSegments{};
-    std::vector<int> maxSegments{};
-    for (int i = 0; i < segmentsIndexes.size(); ++i) {
-        int segIndex = segmentsIndexes[i];
-        if (segmentsMinAttachment[segIndex] == cycleNode) {
-            minSegments.push_back(segIndex);
-            continue;
-        }
-        if (segmentsMaxAttachment[segIndex] == cycleNode) {
-            maxSegments.push_back(segIndex);
-            continue;
+std::optional<Embedding> Embedder::embedGraph(const MyGraph& graph) {
+    if (graph.size() < 4) return baseCaseGraph(graph);
+    PhaseTimer globalFilterTimer(activeStats(), EmbedderPhase::Filters);
+    if (!isWitnessEnabled_m && exceedsEdgeBound(graph)) return reject(PlanarityFilter::GlobalEdgeBound);
+    globalFilterTimer.stop();
+    if (isSmallGraph(graph)) return embedSmallGraph(graph);
+    PhaseTimer componentsTimer(activeStats(), EmbedderPhase::BiconnectedComponents);
+    const BiconnectedComponentsHandler bicComps(graph, workspace_m);
+    componentsTimer.stop();
+    const std::vector<Component>& components = bicComps.getComponents();
+    if (EmbedderStats* stats = activeStats()) stats->numberOfComponents += components.size();
+    // all the components are checked before embedding any of them
+    PhaseTimer componentFiltersTimer(activeStats(), EmbedderPhase::Filters);
+    for (const Component& component : components) {
+        if (isWitnessEnabled_m) continue;
+        if (exceedsEdgeBound(component)) return reject(PlanarityFilter::ComponentEdgeBound);
+        if (exceedsBipartiteEdgeBound(component)) return reject(PlanarityFilter::BipartiteEdgeBound);
+    }
+    componentFiltersTimer.stop();
+    std::vector<std::optional<Embedding>> embeddings{};
+    if (threadPool_m) {
+        embeddings = embedInParallel(components);
+        for (const std::optional<Embedding>& embedding : embeddings) {
+            if (embedding.has_value()) continue;
+            if (isWitnessEnabled_m)
+                for (const Component& component : components) liftWitnessFromComponent(component, graph);
+            return std::nullopt;
         }
-        assert(!middleSegment.has_value());
-        middleSegment = segIndex;
     }
-    // ordering maxSegments
-    for (int i = 0; i < int(maxSegments.size())-1; ++i) {
-        int min = maxSegments[i];
-        for (int j = i+1; j < maxSegments.size(); ++j) {
-            int candidate = maxSegments[j];
-            if (segmentsMinAttachment[candidate] > segmentsMinAttachment[min])
-                continue;
-            if (segmentsMinAttachment[candidate] < segmentsMinAttachment[min]) {
-                min = maxSegments[candidate];
-                continue;
-            }
-            int numAttachmentsMin = segments[min].getAttachments().size();
-            int numAttachmentsCandidate = segments[candidate].getAttachments().size();
-            assert(numAttachmentsMin == 2 || numAttachmentsMin == 3);
-            assert(numAttachmentsCandidate == 2 || numAttachmentsCandidate == 3);
-            if (numAttachmentsMin == 2 && numAttachmentsCandidate == 2) {
-                if (min > candidate)
-                    continue;
-                min = candidate;
-                continue;
-            }
-            if (numAttachmentsCandidate == 3) {
-                assert(numAttachmentsMin == 2);
-                min = candidate;
-            }
+    else {
+        embeddings.reserve(components.size());
+        for (const auto& component : components) {
+            embeddings.push_back(embed(component));
+            if (embeddings.back().has_value()) continue;
+            if (isWitnessEnabled_m) liftWitnessFromComponent(component, graph);
+            return std::nullopt;
         }
-        int temp = maxSegments[min];
-        maxSegments[min] = maxSegments[i];
-        maxSegments[i] = temp;
     }
-    // ordering minSegments
-    for (int i = 0; i < int(minSegments.size())-1; ++i) {
-        int max = minSegments[i];
-        for (int j = i+1; j < minSegments.size(); ++j) {
-            int candidate = minSegments[j];
-            if (segmentsMaxAttachment[candidate] < segmentsMaxAttachment[max])
-                continue;
-            if (segmentsMaxAttachment[candidate] > segmentsMaxAttachment[max]) {
-                max = minSegments[candidate];
-                continue;
-            }
-            int numAttachmentsMax = segments[max].getAttachments().size();
-            int numAttachmentsCandidate = segments[candidate].getAttachments().size();
-            assert(numAttachmentsMax == 2 || numAttachmentsMax == 3);
-            assert(numAttachmentsCandidate == 2 || numAttachmentsCandidate == 3);
-            if (numAttachmentsMax == 2 && numAttachmentsCandidate == 2) {
-                if (max > candidate)
-                    continue;
-                max = candidate;
-                continue;
-            }
-            if (numAttachmentsMax == 3) {
-                assert(numAttachmentsCandidate == 2);
-                max = candidate;
+    PhaseTimer mergeTimer(activeStats(), EmbedderPhase::MergeComponents);
+    return mergeBiconnectedComponents(graph, components, embeddings);
+}
+
+// components are handed out largest first (so that a big one does not start when the others
+// are done), the first non planar one cancels the others; embeddings[i] is the embedding of
+// components[i] whatever the order in which they were computed, so the merge is deterministic
+std::vector<std::optional<Embedding>> Embedder::embedInParallel(const std::vector<Component>& components) {
+    std::vector<int> order(components.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return components[a].numberOfEdges() > components[b].numberOfEdges();
+    });
+    std::vector<std::optional<Embedding>> embeddings(components.size());
+    std::atomic<int> nextIndex{0};
+    isNonPlanar_m.store(false);
+    int numberOfTasks = std::min<int>(threadPool_m->size(), components.size());
+    for (int i = 0; i < numberOfTasks; ++i) {
+        threadPool_m->submit([&](int worker) {
+            Embedder& embedder = *workers_m[worker];
+            while (!embedder.isCancelled()) {
+                int index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+                if (index >= order.size()) break;
+                embeddings[order[index]] = embedder.embed(components[order[index]]);
+                if (!embeddings[order[index]].has_value())
+                    embedder.cancel();
             }
+        });
+    }
+    threadPool_m->wait();
+    return embeddings;
+}
+
+// fork-join over the segments when running on a worker: big segments become tasks, that
+// idle workers can steal, while this thread embeds the small ones and then helps with the
+// rest; a non planar segment makes the whole graph non planar, so it cancels everything
+bool Embedder::embedSegments(const std::vector<Segment>& segments,
+std::vector<std::optional<Embedding>>& embeddings) {
+    if (master_m == nullptr) {
+        for (int i = 0; i < segments.size(); ++i) {
+            embeddings[i] = embed(segments[i]);
+            if (!embeddings[i].has_value()) return false;
         }
-        int temp = minSegments[max];
-        minSegments[max] = minSegments[i];
-        minSegments[i] = temp;
+        return true;
+    }
+    TaskGroup group(*master_m->threadPool_m);
+    int depth = depth_m;
+    for (int i = 0; i < segments.size(); ++i) {
+        if (segments[i].size() < minSegmentSizeForTask) continue;
+        group.run([&, i, depth](int worker) {
+            Embedder& embedder = *master_m->workers_m[worker];
+            if (embedder.isCancelled()) return;
+            // the worker may be in the middle of its own recursion (helping while it waits)
+            int workerDepth = embedder.depth_m;
+            embedder.depth_m = depth;
+            embeddings[i] = embedder.embed(segments[i]);
+            embedder.depth_m = workerDepth;
+            if (!embeddings[i].has_value()) embedder.cancel();
+        });
+    }
+    for (int i = 0; i < segments.size() && !isCancelled(); ++i) {
+        if (segments[i].size() >= minSegmentSizeForTask) continue;
+        embeddings[i] = embed(segments[i]);
+        if (!embeddings[i].has_value()) cancel();
+    }
+    group.wait();
+    for (const std::optional<Embedding>& embedding : embeddings)
+        if (!embedding.has_value()) return false;
+    return true;
+}
+
+// for each segment, it computes the minimum and the maximum of all of its attachments
+// (attachments are kept in cycle order)
+void Embedder::computeMinAndMaxSegmentsAttachments(const std::vector<Segment>& segments,
+std::vector<int>& segmentsMinAttachment, std::vector<int>& segmentsMaxAttachment) {
+    segmentsMinAttachment.resize(segments.size());
+    segmentsMaxAttachment.resize(segments.size());
+    for (int i = 0; i < segments.size(); i++) {
+        segmentsMinAttachment[i] = segments[i].getAttachments().front();
+        segmentsMaxAttachment[i] = segments[i].getAttachments().back();
     }
-    std::vector<int> order{};
-    for (int segmentIndex : maxSegments)
-        order.push_back(segmentIndex);
-    if (middleSegment) order.push_back(middleSegment.value());
-    for (int segmentIndex : minSegments)
-        order.push_back(segmentIndex);
+}
+
+// order in which the segments attached to cycleNode (all on the same side of the cycle)
+// are met going around cycleNode, from the edge towards the next cycle node to the edge
+// towards the previous one: first the segments whose other attachments come after
+// cycleNode (innermost first), then the (at most one) segment with attachments on both
+// sides of cycleNode, then the segments whose other attachments come before cycleNode
+// (outermost first). order is overwritten
+void Embedder::computeOrder(int cycleNode, const std::vector<int>& segmentsIndexes,
+const std::vector<int>& segmentsMinAttachment, const std::vector<int>& segmentsMaxAttachment,
+const std::vector<Segment>& segments, std::vector<int>& order) {
+    order.clear();
+    for (int segIndex : segmentsIndexes)
+        if (segmentsMinAttachment[segIndex] == cycleNode) order.push_back(segIndex);
+    int numberOfMinSegments = order.size();
+    for (int segIndex : segmentsIndexes)
+        if (segmentsMinAttachment[segIndex] != cycleNode && segmentsMaxAttachment[segIndex] != cycleNode)
+            order.push_back(segIndex);
+    int firstMaxSegment = order.size();
+    assert(firstMaxSegment-numberOfMinSegments <= 1);
+    for (int segIndex : segmentsIndexes)
+        if (segmentsMaxAttachment[segIndex] == cycleNode) order.push_back(segIndex);
     assert(order.size() == segmentsIndexes.size());
-    return order;
+    auto hasTwoAttachments = [&](int segIndex) {
+        return segments[segIndex].getAttachments().size() == 2;
+    };
+    // min segments: by increasing max attachment, on ties a segment with more than
+    // 2 attachments comes before one with 2, then by increasing index
+    std::sort(order.begin(), order.begin()+numberOfMinSegments, [&](int first, int second) {
+        if (segmentsMaxAttachment[first] != segmentsMaxAttachment[second])
+            return segmentsMaxAttachment[first] < segmentsMaxAttachment[second];
+        if (hasTwoAttachments(first) != hasTwoAttachments(second))
+            return !hasTwoAttachments(first);
+        return first < second;
+    });
+    // max segments: by increasing min attachment, on ties a segment with 2 attachments
+    // comes before one with more, then by decreasing index (segments with the same
+    // 2 attachments are nested in the opposite order with respect to the min segments)
+    std::sort(order.begin()+firstMaxSegment, order.end(), [&](int first, int second) {
+        if (segmentsMinAttachment[first] != segmentsMinAttachment[second])
+            return segmentsMinAttachment[first] < segmentsMinAttachment[second];
+        if (hasTwoAttachments(first) != hasTwoAttachments(second))
+            return hasTwoAttachments(first);
+        return first > second;
+    });
+}
+
+// the embedding of a segment (with its contracted cycle) may have the segment on either side of the cycle:
+// returns true if around the attachments the segment edges come right after the next cycle node
+bool Embedder::isSegmentEmbeddedInside(const Segment& segment, const Embedding& embedding) {
+    int attachment = 0;
+    std::span<const int> neighbors = embedding.getNeighborsOfNode(attachment);
+    int next = segment.getNextOfAttachment(attachment);
+    int prev = segment.getPrevOfAttachment(attachment);
+    int indexOfNext = findIndex(neighbors, next);
+    assert(indexOfNext != -1);
+    return neighbors[(indexOfNext+1) % neighbors.size()] != prev;
 }
 
-const Embedding Embedder::mergeSegmentsEmbeddings(const Component& component, const Cycle& cycle,
+namespace {
+    // rotations of a graph whose degrees are known: each node gets its range of the
+    // neighbors array up front, the neighbors are added around it in order
+    class RotationsWriter {
+    private:
+        std::vector<int> offsets_m;
+        std::vector<int> neighbors_m;
+        std::vector<int> end_m;
+
+    public:
+        RotationsWriter(const MyGraph& graph)
+            : offsets_m(graph.getOffsets().begin(), graph.getOffsets().end()),
+            neighbors_m(graph.getNeighbors().size()), end_m(offsets_m.begin(), offsets_m.end()-1) {}
+
+        void add(int node, int neighbor) {
+            assert(end_m[node] < offsets_m[node+1]);
+            neighbors_m[end_m[node]++] = neighbor;
+        }
+
+        // every node must have all its neighbors
+        Embedding build() {
+            for (int node = 0; node < end_m.size(); ++node)
+                assert(end_m[node] == offsets_m[node+1]);
+            int numberOfNodes = end_m.size();
+            return Embedding(MyGraph(numberOfNodes, std::move(offsets_m), std::move(neighbors_m)));
+        }
+    };
+}
+
+// adds the segment edges around cycleNode to the output, in the order in which the segment
+// embedding meets them starting from the next cycle node (in the opposite order if mirrored)
+void addSegmentEdgesAroundAttachment(RotationsWriter& output, int cycleNode, const Cycle& cycle,
+const Segment& segment, const Embedding& embedding, bool isMirrored) {
+    int attachment = segment.getAttachmentOfCycleNode(cycleNode);
+    assert(attachment != -1);
+    std::span<const int> neighbors = embedding.getNeighborsOfNode(attachment);
+    int next = segment.getNextOfAttachment(attachment);
+    int prev = segment.getPrevOfAttachment(attachment);
+    int indexOfNext = findIndex(neighbors, next);
+    int cycleNodeLabel = cycle.nodes()[cycleNode];
+    for (int i = 1; i < neighbors.size(); ++i) {
+        int index = isMirrored ? indexOfNext-i+neighbors.size() : indexOfNext+i;
+        int neighbor = neighbors[index % neighbors.size()];
+        if (neighbor == next || neighbor == prev) continue;
+        output.add(cycleNodeLabel, segment.getLabelOfNode(neighbor));
+    }
+}
+
+Embedding Embedder::mergeSegmentsEmbeddings(const Component& component, const Cycle& cycle,
 const std::vector<std::optional<Embedding>>& embeddings, const std::vector<Segment>& segments,
 const std::vector<int>& bipartition) {
-    Embedding output(component.size());
-    int segmentsMinAttachment[segments.size()];
-    int segmentsMaxAttachment[segments.size()];
+    // the merged rotation of each node has the degree of the node in the component
+    RotationsWriter output(component);
+    std::vector<int>& segmentsMinAttachment = workspace_m.segmentsMinAttachment;
+    std::vector<int>& segmentsMaxAttachment = workspace_m.segmentsMaxAttachment;
     computeMinAndMaxSegmentsAttachments(segments, segmentsMinAttachment, segmentsMaxAttachment);
+    // segments placed on the other side with respect to their own embedding must be mirrored
+    std::vector<bool> isMirrored(segments.size());
+    for (int i = 0; i < segments.size(); ++i) {
+        bool isInside = isSegmentEmbeddedInside(segments[i], embeddings[i].value());
+        isMirrored[i] = isInside != (bipartition[i] == 0);
+    }
+    // segments attached to each cycle node (as a graph from cycle nodes to segments)
+    GraphBuilder attachmentsBuilder(cycle.size());
+    for (int i = 0; i < segments.size(); ++i)
+        for (int attachment : segments[i].getAttachments())
+            attachmentsBuilder.addSingleEdge(attachment, i);
+    const MyGraph segmentsOfCycleNode(attachmentsBuilder);
+    std::vector<int> insideSegments{};
+    std::vector<int> outsideSegments{};
+    std::vector<int> insideOrder{};
+    std::vector<int> outsideOrder{};
     for (int node = 0; node < cycle.size(); ++node) {
-        std::vector<int> insideSegments{};
-        std::vector<int> outsideSegments{};
-        for (int i = 0; i < segments.size(); ++i)
-            if (segments[i].isNodeAnAttachment(node)) {
-                if (bipartition[i] == 0) insideSegments.push_back(i);
-                else outsideSegments.push_back(i);
-            }
+        insideSegments.clear();
+        outsideSegments.clear();
+        for (int i : segmentsOfCycleNode.getNeighborsOfNode(node)) {
+            if (bipartition[i] == 0) insideSegments.push_back(i);
+            else outsideSegments.push_back(i);
+        }
         int cycleNodeLabel = cycle.nodes()[node];
         int prevCycleNodeLabel = cycle.getPrevOfNode(cycleNodeLabel);
         int nextCycleNodeLabel = cycle.getNextOfNode(cycleNodeLabel);
         // order of the segments inside the cycle
-        std::vector<int> insideOrder = computeOrder(node, insideSegments, segmentsMinAttachment, segmentsMaxAttachment, segments);
-        // order of the segments outside the cycle
-        std::vector<int> outsideOrder = computeOrder(node, outsideSegments, segmentsMinAttachment, segmentsMaxAttachment, segments);
-        output.addSingleEdge(cycleNodeLabel, nextCycleNodeLabel);
+        computeOrder(node, insideSegments, segmentsMinAttachment, segmentsMaxAttachment, segments, insideOrder);
+        // order of the segments outside the cycle (met from the previous cycle node to the next one)
+        computeOrder(node, outsideSegments, segmentsMinAttachment, segmentsMaxAttachment, segments, outsideOrder);
+        std::reverse(outsideOrder.begin(), outsideOrder.end());
+        output.add(cycleNodeLabel, nextCycleNodeLabel);
         for (int i = 0; i < insideOrder.size(); ++i) {
-            const Segment& segment = segments[insideOrder[i]];
-            const Embedding& embedding = embeddings[insideOrder[i]].value();
-            assert(segment.isNodeAnAttachment(node));
-            for (int neighbor : embedding.getNeighborsOfNode(node)) {
-                int label = segment.getLabelOfNode(neighbor);
-                if (cycle.getNextOfNode(cycleNodeLabel) == label) continue;
-                if (cycle.getPrevOfNode(cycleNodeLabel) == label) continue;
-                output.addSingleEdge(cycleNodeLabel, label);
-            }
+            int index = insideOrder[i];
+            addSegmentEdgesAroundAttachment(output, node, cycle, segments[index], embeddings[index].value(), isMirrored[index]);
         }
-        output.addSingleEdge(cycleNodeLabel, prevCycleNodeLabel);
+        output.add(cycleNodeLabel, prevCycleNodeLabel);
         for (int i = 0; i < outsideOrder.size(); ++i) {
-            const Segment& segment = segments[outsideOrder[i]];
-            const Embedding& embedding = embeddings[outsideOrder[i]].value();
-            for (int neighbor : embedding.getNeighborsOfNode(node)) {
-                int label = segment.getLabelOfNode(neighbor);
-                if (cycle.getNextOfNode(cycleNodeLabel) == label) continue;
-                if (cycle.getPrevOfNode(cycleNodeLabel) == label) continue;
-                output.addSingleEdge(cycleNodeLabel, label);
-            }
+            int index = outsideOrder[i];
+            addSegmentEdgesAroundAttachment(output, node, cycle, segments[index], embeddings[index].value(), isMirrored[index]);
         }
     }
     for (int i = 0; i < segments.size(); ++i) {
         const Segment& segment = segments[i];
         const Embedding& embedding = embeddings[i].value();
-        for (int node = 0; node < segment.size(); ++node) {
+        for (int node = segment.getAttachments().size(); node < segment.size(); ++node) {
+            if (segment.isNodeADummy(node)) continue;
             int label = segment.getLabelOfNode(node);
-            if (cycle.hasNode(label)) continue;
-            for (int neighbor : embedding.getNeighborsOfNode(node)) {
-                int neighborLabel = segment.getLabelOfNode(neighbor);
-                output.addSingleEdge(label, neighborLabel);
+            std::span<const int> neighbors = embedding.getNeighborsOfNode(node);
+            for (int j = 0; j < neighbors.size(); ++j) {
+                int neighbor = isMirrored[i] ? neighbors[neighbors.size()-1-j] : neighbors[j];
+                output.add(label, segment.getLabelOfNode(neighbor));
             }
-        } 
+        }
     }
-    return output;
+    return output.build();
 }
 
-std::optional<const Embedding> Embedder::embed(const Component& component, Cycle& cycle) {
-    SegmentsHandler segmentsHandler = SegmentsHandler(component, cycle);
-    const std::vector<Segment>& segments = segmentsHandler.getSegments();
+std::optional<Embedding> Embedder::embed(const Component& component, Cycle& cycle) {
+    if (isCancelled()) return std::nullopt;
+    EmbedderStats* stats = activeStats();
+    auto countCycle = [&]() {
+        if (stats == nullptr) return;
+        ++stats->numberOfCycles;
+        stats->totalCycleLength += cycle.size();
+        stats->maxCycleLength = std::max(stats->maxCycleLength, cycle.size());
+    };
+    countCycle();
+    PhaseTimer segmentsTimer(stats, EmbedderPhase::Segments);
+    std::optional<SegmentsHandler> segmentsHandler(std::in_place, component, cycle, workspace_m);
+    segmentsTimer.stop();
+    while (segmentsHandler->isCycleBad()) {
+        // chosen cycle is bad (its segment was not built): the segments of the new cycle are
+        // found only around the nodes the change touched
+        PhaseTimer makeCycleGoodTimer(stats, EmbedderPhase::MakeCycleGood);
+        std::vector<int> changedNodes = makeCycleGood(cycle, segmentsHandler.value());
+        makeCycleGoodTimer.stop();
+        if (stats != nullptr) ++stats->numberOfCycleRewrites;
+        countCycle();
+        PhaseTimer changedSegmentsTimer(stats, EmbedderPhase::Segments);
+        segmentsHandler.emplace(component, cycle, changedNodes, workspace_m);
+    }
+    const std::vector<Segment>& segments = segmentsHandler->getSegments();
     if (segments.size() == 0) // entire biconnected component IS the cycle
         return baseCaseCycle(cycle); // base case
-    if (segments.size() == 1) {
-        const Segment& segment = segments[0];
-        if (segment.isPath()) // base case
-            return baseCaseSegment(segment);
-        // chosen cycle is bad
-        makeCycleGood(cycle, segment);
-        return embed(component, cycle);
+    if (stats != nullptr) {
+        stats->numberOfSegments += segments.size();
+        for (const Segment& segment : segments)
+            if (segment.isChord()) ++stats->numberOfChords;
+    }
+    for (const Segment& segment : segments)
+        if (!isWitnessEnabled_m && exceedsEdgeBound(segment)) return reject(PlanarityFilter::SegmentEdgeBound);
+    std::optional<std::vector<int>> bipartition{};
+    long long numberOfConflicts = 0;
+    if (isWitnessEnabled_m) {
+        // the witness comes from an odd cycle of the whole interlacement graph
+        PhaseTimer interlacementTimer(stats, EmbedderPhase::Interlacement);
+        InterlacementGraph interlacementGraph(cycle, segments, workspace_m);
+        interlacementTimer.stop();
+        numberOfConflicts = interlacementGraph.numberOfEdges();
+        PhaseTimer bipartitionTimer(stats, EmbedderPhase::Bipartition);
+        bipartition = interlacementGraph.computeBipartition();
+        bipartitionTimer.stop();
+        if (!bipartition) recordWitness(component, cycle, segments, interlacementGraph);
+    }
+    else {
+        // conflicts are not kept, the bipartition is built (or refuted) while they are found
+        PhaseTimer interlacementTimer(stats, EmbedderPhase::Interlacement);
+        bipartition = computeInterlacementBipartition(cycle, segments, workspace_m, numberOfConflicts);
+    }
+    if (stats != nullptr) {
+        stats->numberOfInterlacementEdges += numberOfConflicts;
+        stats->maxInterlacementEdges = std::max(stats->maxInterlacementEdges, int(numberOfConflicts));
     }
-    InterlacementGraph interlacementGraph(cycle, segments);
-    std::optional<std::vector<int>> bipartition = interlacementGraph.computeBipartition();
     if (!bipartition) return std::nullopt;
-    std::vector<std::optional<Embedding>> embeddings{};
-    for (const Segment& segment : segments) {
-        embeddings.push_back(embed(segment));
-        if (!embeddings.back().has_value()) return std::nullopt;
-        for (int i = 0; i < cycle.size(); ++i) {
-            assert(segment.getLabelOfNode(i) == cycle.nodes()[i]);
-        }
+    std::vector<std::optional<Embedding>> embeddings(segments.size());
+    if (!embedSegments(segments, embeddings)) {
+        if (isWitnessEnabled_m)
+            for (const Segment& segment : segments) liftWitnessFromSegment(segment, component);
+        return std::nullopt;
     }
+    PhaseTimer mergeTimer(stats, EmbedderPhase::MergeSegments);
     return mergeSegmentsEmbeddings(component, cycle, embeddings, segments, bipartition.value());
 }
 
-std::optional<const Embedding> Embedder::embed(const Component& component) {
-    Cycle cycle(component);
-    return embed(component, cycle);
+// embeds the segment together with its contracted cycle
+std::optional<Embedding> Embedder::embed(const Segment& segment) {
+    if (segment.isPath()) return baseCaseSegment(segment); // base case
+    return embed(static_cast<const Component&>(segment));
+}
+
+std::optional<Embedding> Embedder::embed(const Component& component) {
+    if (component.size() < 3) return baseCaseGraph(component); // single edge or isolated node
+    if (isSmallGraph(component)) return embedSmallGraph(component);
+    PhaseTimer cycleTimer(activeStats(), EmbedderPhase::Cycle);
+    Cycle cycle(component, workspace_m);
+    cycleTimer.stop();
+    ++depth_m;
+    if (EmbedderStats* stats = activeStats())
+        stats->maxRecursionDepth = std::max(stats->maxRecursionDepth, depth_m);
+    std::optional<Embedding> embedding = embed(component, cycle);
+    --depth_m;
+    return embedding;
 }
 
-void Embedder::makeCycleGood(Cycle& cycle, const Segment& segment) {
-    const std::vector<int>& attachments = segment.getAttachments();
-    std::vector<int> attachmentsLabels{};
+// attachments are in cycle order, so the first ones met going around the cycle are the first ones.
+// the segment of the bad cycle is split by the path that enters the cycle, the arc that leaves the
+// cycle becomes a segment: returns the nodes of both, the only ones whose segments change
+std::vector<int> Embedder::makeCycleGood(Cycle& cycle, const SegmentsHandler& segmentsHandler) {
+    const std::vector<int>& attachments = segmentsHandler.getBadSegmentAttachments();
+    int nodeToInclude = -1;
+    if (attachments.size() > 2)
+        nodeToInclude = cycle.nodes()[attachments[2]];
+    std::vector<int> path = segmentsHandler.computePathBetweenAttachments(0, 1);
+    std::vector<int> changedNodes(segmentsHandler.getBadSegmentNodes());
     for (int attachment : attachments)
-        attachmentsLabels.push_back(segment.getLabelOfNode(attachment));
-    int foundAttachments = 0;
-    int attachmentsToFind = 3;
-    int attachmentsToUse[3];
-    if (attachmentsLabels.size() == 2) {
-        attachmentsToFind = 2;
-        attachmentsToUse[2] = -1;
-    }
-    for (int i = 0; i < cycle.size(); ++i) {
-        int node = cycle.nodes()[i];
-        int index = findIndex(attachmentsLabels, node);
-        if (index == -1) continue;
-        attachmentsToUse[foundAttachments++] = attachments[index];
-        if (foundAttachments == attachmentsToFind) break;
-    }
-    if (attachmentsToUse[2] != -1)
-        attachmentsToUse[2] = segment.getLabelOfNode(attachmentsToUse[2]);
-    assert(foundAttachments == attachmentsToFind);
-    std::list<int> path = segment.computePathBetweenAttachments(attachmentsToUse[0], attachmentsToUse[1]);
-    for (int& node : path)
-        node = segment.getLabelOfNode(node);
-    cycle.changeWithPath(path, attachmentsToUse[2]);
+        changedNodes.push_back(cycle.nodes()[attachment]);
+    cycle.changeWithPath(path, nodeToInclude, changedNodes);
+    return changedNodes;
+}
+
+bool Embedder::isSmallGraph(const MyGraph& graph) const {
+    return isSmallGraphEngineEnabled_m && !isWitnessEnabled_m && graph.size() <= SmallGraphEmbedder::maxNodes;
+}
+
+std::optional<Embedding> Embedder::embedSmallGraph(const MyGraph& graph) {
+    PhaseTimer timer(activeStats(), EmbedderPhase::SmallGraphs);
+    if (smallGraphEmbedder_m == nullptr) smallGraphEmbedder_m = std::make_unique<SmallGraphEmbedder>();
+    return smallGraphEmbedder_m->embed(graph);
 }
 
 // base case: graph has <4 nodes
-const Embedding Embedder::baseCaseGraph(const MyGraph& graph) {
+Embedding Embedder::baseCaseGraph(const MyGraph& graph) {
     assert(graph.size() < 4);
-    Embedding embedding(graph.size());
+    PhaseTimer timer(activeStats(), EmbedderPhase::BaseCases);
+    GraphBuilder embedding(graph.size());
     for (int node = 0; node < graph.size(); ++node) {
         for (int neighbor : graph.getNeighborsOfNode(node))
             if (node < neighbor) embedding.addEdge(node, neighbor);
     }
-    return embedding;
+    return Embedding(embedding);
 }
 
-// base case: segment is a path
-const Embedding Embedder::baseCaseSegment(const Segment& segment) {
-    assert(segment.size() == segment.getOriginalComponent().size());
+// base case: segment is a path (with 2 attachments, so its contracted cycle has 2 dummy nodes)
+Embedding Embedder::baseCaseSegment(const Segment& segment) {
     assert(segment.isPath());
-    Embedding embedding(segment.size());
-    for (int node = 0; node < segment.size(); ++node) {
-        int label = segment.getLabelOfNode(node);
-        const std::vector<int>& neighbors = segment.getNeighborsOfNode(node);
-        if (neighbors.size() == 2) { // attachment nodes will be handled later
-            
-            embedding.addSingleEdge(label, segment.getLabelOfNode(neighbors[0]));
-            embedding.addSingleEdge(label, segment.getLabelOfNode(neighbors[1]));
-        }
-    }
-    // handling attachment nodes (which have 3 neighbors)
     assert(segment.getAttachments().size() == 2);
-    for (int attachment : segment.getAttachments()) {
-        int label = segment.getLabelOfNode(attachment);
-        int neighbors[3];
-        assert(embedding.getNeighborsOfNode(label).size() == 0);
-        assert(segment.getNeighborsOfNode(attachment).size() == 3);
-        for (int i = 0; i < 3; ++i)
-            neighbors[i] = -1;
-        for (int neighbor : segment.getNeighborsOfNode(attachment)) {
-            int neighborLabel = segment.getLabelOfNode(neighbor);
-            if (segment.getOriginalCycle().getNextOfNode(label) == neighborLabel) {
-                neighbors[0] = neighbor;
-                continue;
-            }
-            if (segment.getOriginalCycle().getPrevOfNode(label) == neighborLabel) {
-                neighbors[2] = neighbor;
-                continue;
-            }
-            neighbors[1] = neighbor;
-        }
-        for (int i = 0; i < 3; ++i) {
-            assert(neighbors[i] != -1);
-            embedding.addSingleEdge(label, segment.getLabelOfNode(neighbors[i]));
+    PhaseTimer timer(activeStats(), EmbedderPhase::BaseCases);
+    GraphBuilder embedding(segment.size());
+    for (int node = 0; node < segment.size(); ++node) {
+        std::span<const int> neighbors = segment.getNeighborsOfNode(node);
+        assert(neighbors.size() == 2 || segment.isNodeAnAttachment(node));
+        if (!segment.isNodeAnAttachment(node)) {
+            embedding.addSingleEdge(node, neighbors[0]);
+            embedding.addSingleEdge(node, neighbors[1]);
+            continue;
         }
+        // attachment: next cycle node, path, prev cycle node
+        int next = segment.getNextOfAttachment(node);
+        int prev = segment.getPrevOfAttachment(node);
+        embedding.addSingleEdge(node, next);
+        for (const int neighbor : neighbors)
+            if (neighbor != next && neighbor != prev)
+                embedding.addSingleEdge(node, neighbor);
+        embedding.addSingleEdge(node, prev);
     }
-    return embedding;
+    return Embedding(embedding);
 }
 
 // base case: biconnected component is a cycle
-const Embedding Embedder::baseCaseCycle(const Cycle& cycle) {
-    Embedding embedding(cycle.size());
-    for (int node = 1; node < cycle.size()-1; ++node)
+Embedding Embedder::baseCaseCycle(const Cycle& cycle) {
+    PhaseTimer timer(activeStats(), EmbedderPhase::BaseCases);
+    GraphBuilder embedding(cycle.size());
+    for (int node = 0; node < cycle.size()-1; ++node)
         embedding.addEdge(cycle.nodes()[node], cycle.nodes()[node+1]);
     embedding.addEdge(cycle.nodes()[0], cycle.nodes()[cycle.size()-1]);
-    return embedding;
+    return Embedding(embedding);
 }
\ No newline at end of file
@@ -4,38 +4,129 @@
 #include <optional>
 #include <vector>
 #include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <utility>
 
 #include "graph.hpp"
 #include "biconnectedComponent.hpp"
 #include "cycle.hpp"
 #include "segment.hpp"
+#include "workspace.hpp"
+#include "threadPool.hpp"
+#include "planarityFilter.hpp"
+#include "embedderStats.hpp"
+
+class ResultCache;
+class SmallGraphEmbedder;
 
 class Embedding : public MyGraph {
 public:
-    Embedding(int numberOfNodes);
+    Embedding(const GraphBuilder& builder);
+    // the neighbors of each node of rotations, in order, are its rotation
+    explicit Embedding(MyGraph&& rotations);
 
-    void addSingleEdge(int from, int to);
-    void saveToSvg(std::string& path) const;
+    // straight line grid drawing (see PlanarDrawing), in linear time: false if the file could not be written
+    bool saveToSvg(const std::string& path) const;
+    // layout with OGDF PlanarDrawLayout, much slower: false if the file could not be
+    // written or if the program was built without OGDF
+    bool saveToOgdfSvg(const std::string& path) const;
 };
 
+// embeddings are returned as non const values so that they are moved, not copied,
+// on their way up the recursion
+// with more than one thread, biconnected components and big enough segments are embedded
+// as tasks of a thread pool, each worker thread using its own Embedder (so its own workspace)
 class Embedder {
 private:
-    void makeCycleGood(Cycle& cycle, const Segment& segment);
-    const Embedding baseCaseGraph(const MyGraph& graph);
-    const Embedding baseCaseSegment(const Segment& segment);
-    const Embedding baseCaseCycle(const Cycle& cycle);
-    std::optional<const Embedding> embed(const Component& component);
-    std::optional<const Embedding> embed(const Component& component, Cycle& cycle);
+    // segments with fewer nodes are embedded by the thread that found them
+    static constexpr int minSegmentSizeForTask = 1024;
+
+    EmbedderWorkspace workspace_m{};
+    std::unique_ptr<ThreadPool> threadPool_m{};
+    std::vector<std::unique_ptr<Embedder>> workers_m{};
+    // the Embedder owning the thread pool, for the workers
+    Embedder* master_m{nullptr};
+    // set as soon as any task finds a non planar component or segment, the others give up
+    std::atomic<bool> isNonPlanar_m{false};
+    // filter that proved the last graph non planar (the first one, if tasks race)
+    std::atomic<PlanarityFilter> decidingFilter_m{PlanarityFilter::None};
+    bool isSeriesReductionEnabled_m{true};
+    bool isStatisticsEnabled_m{false};
+    bool isWitnessEnabled_m{false};
+    // the witness is kept by the Embedder owning the thread pool: the first failure records it
+    // as edges of the graph it failed on, then every level it goes back through lifts it
+    // to its own graph (witnessGraph_m is the graph whose nodes the witness uses)
+    std::mutex witnessMutex_m{};
+    const MyGraph* witnessGraph_m{nullptr};
+    std::vector<std::pair<int, int>> witness_m{};
+    EmbedderStats stats_m{};
+    // depth of the current component in the recursion (top level components are at depth 1)
+    int depth_m{0};
+    ResultCache* cache_m{nullptr};
+    bool isLastResultCached_m{false};
+    // graphs, components and segments of at most SmallGraphEmbedder::maxNodes nodes go to it
+    // (not with witness extraction)
+    std::unique_ptr<SmallGraphEmbedder> smallGraphEmbedder_m;
+    bool isSmallGraphEngineEnabled_m{true};
+
+    std::vector<int> makeCycleGood(Cycle& cycle, const SegmentsHandler& segmentsHandler);
+    Embedding baseCaseGraph(const MyGraph& graph);
+    Embedding baseCaseSegment(const Segment& segment);
+    Embedding baseCaseCycle(const Cycle& cycle);
+    bool isSmallGraph(const MyGraph& graph) const;
+    std::optional<Embedding> embedSmallGraph(const MyGraph& graph);
+    std::optional<Embedding> embedUncached(const MyGraph& graph);
+    std::optional<Embedding> reduceAndEmbed(const MyGraph& graph);
+    std::optional<Embedding> embedGraph(const MyGraph& graph);
+    std::optional<Embedding> embed(const Component& component);
+    std::optional<Embedding> embed(const Component& component, Cycle& cycle);
+    std::optional<Embedding> embed(const Segment& segment);
     void computeMinAndMaxSegmentsAttachments(const std::vector<Segment>& segments,
-        int segmentsMinAttachment[], int segmentsMaxAttachment[]);
-    const std::vector<int> computeOrder(int cycleNode, const std::vector<int>& segmentsIndexes,
-        int segmentsMinAttachment[], int segmentsMaxAttachment[], const std::vector<Segment>& segments);
-    const Embedding mergeSegmentsEmbeddings(const Component& component, const Cycle& cycle,
+        std::vector<int>& segmentsMinAttachment, std::vector<int>& segmentsMaxAttachment);
+    void computeOrder(int cycleNode, const std::vector<int>& segmentsIndexes,
+        const std::vector<int>& segmentsMinAttachment, const std::vector<int>& segmentsMaxAttachment,
+        const std::vector<Segment>& segments, std::vector<int>& order);
+    bool isSegmentEmbeddedInside(const Segment& segment, const Embedding& embedding);
+    Embedding mergeSegmentsEmbeddings(const Component& component, const Cycle& cycle,
         const std::vector<std::optional<Embedding>>& embeddings, const std::vector<Segment>& segments,
         const std::vector<int>& bipartition);
+    EmbedderStats* activeStats();
+    Embedder& owner();
+    void recordWitness(const Component& component, const Cycle& cycle, const std::vector<Segment>& segments,
+        const MyGraph& interlacementGraph);
+    void liftWitnessFromSegment(const Segment& segment, const Component& component);
+    void liftWitnessFromComponent(const Component& component, const MyGraph& graph);
+    bool isCancelled() const;
+    void cancel();
+    std::nullopt_t reject(PlanarityFilter filter);
+    std::vector<std::optional<Embedding>> embedInParallel(const std::vector<Component>& components);
+    bool embedSegments(const std::vector<Segment>& segments, std::vector<std::optional<Embedding>>& embeddings);
 
 public:
-    std::optional<const Embedding> embed(const MyGraph& graph);
+    Embedder(int numberOfThreads = 1);
+    ~Embedder();
+
+    std::optional<Embedding> embed(const MyGraph& graph);
+    // paths of nodes of degree 2 are contracted before embedding (and expanded back after)
+    void setSeriesReduction(bool isEnabled);
+    // graphs, components and segments with at most 64 nodes are embedded with SmallGraphEmbedder
+    void setSmallGraphEngine(bool isEnabled);
+    // None if the last graph embedded is planar or was rejected by the whole algorithm
+    PlanarityFilter getDecidingFilter() const;
+    // per phase times and counters of each embed call, collected only if enabled
+    void setStatistics(bool isEnabled);
+    const EmbedderStats& getStatistics() const;
+    // when the last graph is not planar, edges of a subdivision of K5 or K3,3 in it
+    // (filters are skipped, they prove non planarity without a witness)
+    void setWitnessExtraction(bool isEnabled);
+    const std::vector<std::pair<int, int>>& getWitness() const;
+    // results are looked up in cache before embedding and stored in it after (not with witness
+    // extraction, which needs the whole run); nullptr for none. the cache must outlive its use
+    void setCache(ResultCache* cache);
+    // the last graph was found in the cache (its statistics are then empty)
+    bool isLastResultCached() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "embedderStats.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+const char* phaseName(EmbedderPhase phase) {
+    switch (phase) {
+        case EmbedderPhase::SeriesReduction: return "series reduction";
+        case EmbedderPhase::Filters: return "filters";
+        case EmbedderPhase::BiconnectedComponents: return "biconnected components";
+        case EmbedderPhase::Cycle: return "cycle";
+        case EmbedderPhase::Segments: return "segments";
+        case EmbedderPhase::Interlacement: return "interlacement";
+        case EmbedderPhase::Bipartition: return "bipartition";
+        case EmbedderPhase::MakeCycleGood: return "make cycle good";
+        case EmbedderPhase::BaseCases: return "base cases";
+        case EmbedderPhase::SmallGraphs: return "small graphs";
+        case EmbedderPhase::MergeSegments: return "merge segments";
+        case EmbedderPhase::MergeComponents: return "merge components";
+        case EmbedderPhase::SeriesExpansion: return "series expansion";
+        case EmbedderPhase::Witness: return "witness";
+        case EmbedderPhase::Count: break;
+    }
+    return "unknown";
+}
+
+void EmbedderStats::clear() {
+    *this = EmbedderStats{};
+}
+
+void EmbedderStats::add(const EmbedderStats& other) {
+    for (int phase = 0; phase < numberOfPhases; ++phase) {
+        phaseMilliseconds[phase] += other.phaseMilliseconds[phase];
+        phaseCalls[phase] += other.phaseCalls[phase];
+    }
+    maxRecursionDepth = std::max(maxRecursionDepth, other.maxRecursionDepth);
+    numberOfComponents += other.numberOfComponents;
+    numberOfCycles += other.numberOfCycles;
+    numberOfCycleRewrites += other.numberOfCycleRewrites;
+    totalCycleLength += other.totalCycleLength;
+    maxCycleLength = std::max(maxCycleLength, other.maxCycleLength);
+    numberOfSegments += other.numberOfSegments;
+    numberOfChords += other.numberOfChords;
+    numberOfInterlacementEdges += other.numberOfInterlacementEdges;
+    maxInterlacementEdges = std::max(maxInterlacementEdges, other.maxInterlacementEdges);
+}
+
+void EmbedderStats::print(std::ostream& output) const {
+    double averageCycleLength = numberOfCycles > 0 ? double(totalCycleLength)/numberOfCycles : 0;
+    output << "total: " << totalMilliseconds << " ms, recursion depth: " << maxRecursionDepth
+           << ", components: " << numberOfComponents << "\n"
+           << "cycles: " << numberOfCycles << " (average length " << averageCycleLength
+           << ", max " << maxCycleLength << ", " << numberOfCycleRewrites << " rewritten)"
+           << ", segments: " << numberOfSegments
+           << " (" << numberOfChords << " chords), interlacement edges: " << numberOfInterlacementEdges
+           << " (max " << maxInterlacementEdges << ")\n";
+    for (int phase = 0; phase < numberOfPhases; ++phase) {
+        output << "  " << std::left << std::setw(24) << phaseName(static_cast<EmbedderPhase>(phase))
+               << std::right << std::setw(10) << phaseCalls[phase] << " calls "
+               << std::setw(12) << phaseMilliseconds[phase] << " ms\n";
+    }
+}
+
+// a JSON object, phase names with underscores
+void EmbedderStats::writeJson(std::ostream& output) const {
+    output << "{\"total_ms\":" << totalMilliseconds << ",\"depth\":" << maxRecursionDepth
+           << ",\"components\":" << numberOfComponents << ",\"cycles\":" << numberOfCycles
+           << ",\"cycle_rewrites\":" << numberOfCycleRewrites << ",\"cycle_length_total\":" << totalCycleLength
+           << ",\"cycle_length_max\":" << maxCycleLength
+           << ",\"segments\":" << numberOfSegments << ",\"chords\":" << numberOfChords
+           << ",\"interlacement_edges\":" << numberOfInterlacementEdges
+           << ",\"interlacement_edges_max\":" << maxInterlacementEdges << ",\"phases\":{";
+    for (int phase = 0; phase < numberOfPhases; ++phase) {
+        std::string name(phaseName(static_cast<EmbedderPhase>(phase)));
+        std::replace(name.begin(), name.end(), ' ', '_');
+        output << (phase > 0 ? "," : "") << "\"" << name << "\":{\"calls\":" << phaseCalls[phase]
+               << ",\"ms\":" << phaseMilliseconds[phase] << "}";
+    }
+    output << "}}";
+}
\ No newline at end of file
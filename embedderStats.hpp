@@ -0,0 +1,83 @@
+#ifndef MY_EMBEDDER_STATS_H
+#define MY_EMBEDDER_STATS_H
+
+#include <array>
+#include <chrono>
+#include <ostream>
+
+// phases are disjoint: a phase never includes the recursion it leads to
+enum class EmbedderPhase {
+    SeriesReduction,
+    Filters,
+    BiconnectedComponents,
+    Cycle,
+    Segments,
+    Interlacement,
+    Bipartition,
+    MakeCycleGood,
+    BaseCases,
+    SmallGraphs,
+    MergeSegments,
+    MergeComponents,
+    SeriesExpansion,
+    Witness,
+    Count
+};
+
+const char* phaseName(EmbedderPhase phase);
+
+// what one embed call did; with more than one thread the workers counters are added up,
+// so phase times are summed over the threads (and can exceed the total time)
+struct EmbedderStats {
+    static constexpr int numberOfPhases = static_cast<int>(EmbedderPhase::Count);
+
+    std::array<double, numberOfPhases> phaseMilliseconds{};
+    std::array<long long, numberOfPhases> phaseCalls{};
+    double totalMilliseconds{};
+    int maxRecursionDepth{};
+    long long numberOfComponents{};
+    long long numberOfCycles{}; // including the ones changed by makeCycleGood
+    long long numberOfCycleRewrites{}; // by makeCycleGood
+    long long totalCycleLength{};
+    int maxCycleLength{};
+    long long numberOfSegments{};
+    long long numberOfChords{};
+    // conflicts between segments seen (without witnesses, only until the first odd cycle)
+    long long numberOfInterlacementEdges{};
+    int maxInterlacementEdges{};
+
+    void clear();
+    // adds the counters of a worker
+    void add(const EmbedderStats& other);
+    void print(std::ostream& output) const;
+    void writeJson(std::ostream& output) const;
+};
+
+// adds the time from its creation to stop (or its destruction) to the phase;
+// with a null stats it does nothing, not even reading the clock
+class PhaseTimer {
+private:
+    EmbedderStats* stats_m;
+    EmbedderPhase phase_m;
+    std::chrono::steady_clock::time_point start_m{};
+
+public:
+    PhaseTimer(EmbedderStats* stats, EmbedderPhase phase) : stats_m(stats), phase_m(phase) {
+        if (stats_m != nullptr) start_m = std::chrono::steady_clock::now();
+    }
+
+    ~PhaseTimer() {
+        stop();
+    }
+
+    void stop() {
+        if (stats_m == nullptr) return;
+        int phase = static_cast<int>(phase_m);
+        stats_m->phaseMilliseconds[phase] += std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now()-start_m).count();
+        ++stats_m->phaseCalls[phase];
+        stats_m = nullptr;
+    }
+};
+
+#endif
\ No newline at end of file
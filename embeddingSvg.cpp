@@ -0,0 +1,70 @@
+#include "embedder.hpp"
+
+// the only part of the program using OGDF, left out of builds without it (MY_WITHOUT_OGDF)
+#ifdef MY_WITHOUT_OGDF
+
+bool Embedding::saveToOgdfSvg(const std::string&) const {
+    return false;
+}
+
+#else
+
+#include <ogdf/basic/Graph.h>
+#include <ogdf/basic/GraphAttributes.h>
+#include <ogdf/planarlayout/PlanarDrawLayout.h>
+#include <ogdf/fileformats/GraphIO.h>
+
+using namespace ogdf;
+
+Graph myGraphToOgdf(const MyGraph& myGraph) {
+    Graph graph;
+    std::vector<node> nodes(myGraph.size());
+    for (int n = 0; n < myGraph.size(); ++n)
+        nodes[n] = graph.newNode();
+    for (int n = 0; n < myGraph.size(); ++n)
+        for (int neighbor : myGraph.getNeighborsOfNode(n))
+            if (n < neighbor)
+                graph.newEdge(nodes[n], nodes[neighbor]);
+    return graph;
+}
+
+Graph embeddingToOgdfGraph(const Embedding& embedding) {
+    Graph graph = myGraphToOgdf(embedding);
+    std::vector<int> position(embedding.size());
+    for (node n : graph.nodes) {
+        const int label = n->index();
+        std::span<const int> neighbors = embedding.getNeighborsOfNode(label);
+        for (int i = 0; i < neighbors.size(); ++i)
+            position[neighbors[i]] = i;
+        std::vector<adjEntry> order(neighbors.size());
+        for (adjEntry& adj : n->adjEntries) {
+            const int neighbor = adj->twinNode()->index();
+            order[position[neighbor]] = adj;
+        }
+        List<adjEntry> newOrder;
+        for (adjEntry& adj : order)
+            newOrder.pushBack(adj);
+        graph.sort(n, newOrder);
+    }
+    return graph;
+}
+
+bool Embedding::saveToOgdfSvg(const std::string& outputPath) const {
+    Graph graph = embeddingToOgdfGraph(*this);
+    GraphAttributes GA(graph, GraphAttributes::nodeGraphics | GraphAttributes::edgeGraphics |
+                        GraphAttributes::nodeLabel | GraphAttributes::edgeStyle |
+                        GraphAttributes::nodeStyle | GraphAttributes::edgeArrow);
+    for (node v : graph.nodes) {
+        GA.label(v) = std::to_string(v->index());
+        GA.shape(v) = Shape::Ellipse;
+    }
+    for (edge e : graph.edges) {
+        GA.strokeWidth(e) = 1.5;
+        GA.arrowType(e) = EdgeArrow::None;
+    }
+    PlanarDrawLayout layout;
+    layout.call(GA);
+    return GraphIO::write(GA, outputPath);
+}
+
+#endif
\ No newline at end of file
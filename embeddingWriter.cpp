@@ -0,0 +1,78 @@
+#include "embeddingWriter.hpp"
+
+#include <cstring>
+#include <bit>
+#include <span>
+
+#include "embedder.hpp"
+#include "bufferedWriter.hpp"
+
+static_assert(std::endian::native == std::endian::little, "binary embeddings are little endian");
+static_assert(sizeof(BinaryEmbeddingHeader) == 40);
+
+namespace {
+    uint64_t zigzag(int64_t value) {
+        return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+    }
+}
+
+bool saveEmbeddingText(const Embedding& embedding, const char* path) {
+    BufferedWriter writer(path);
+    if (!writer.isGood()) return false;
+    writer.writeNumber(embedding.size(), '\n');
+    for (int node = 0; node < embedding.size(); ++node) {
+        std::span<const int> neighbors = embedding.getNeighborsOfNode(node);
+        writer.writeNumber(neighbors.size(), neighbors.empty() ? '\n' : ' ');
+        for (int i = 0; i < neighbors.size(); ++i)
+            writer.writeNumber(neighbors[i], i+1 == neighbors.size() ? '\n' : ' ');
+    }
+    return writer.close();
+}
+
+// the payload size is only known at the end, the header is written again then
+bool saveEmbeddingBinary(const Embedding& embedding, const char* path) {
+    BufferedWriter writer(path);
+    if (!writer.isGood()) return false;
+    BinaryEmbeddingHeader header{};
+    std::memcpy(header.magic, binaryEmbeddingMagic, sizeof(binaryEmbeddingMagic));
+    header.version = binaryEmbeddingVersion;
+    header.headerSize = sizeof(BinaryEmbeddingHeader);
+    header.numberOfNodes = embedding.size();
+    header.numberOfHalfEdges = embedding.getNeighbors().size();
+    writer.writeBytes(&header, sizeof(header));
+    uint64_t payloadSize = 0;
+    auto countedVarint = [&](uint64_t value) {
+        writer.writeVarint(value);
+        payloadSize += value == 0 ? 1 : (std::bit_width(value)+6)/7;
+    };
+    for (int node = 0; node < embedding.size(); ++node) {
+        std::span<const int> neighbors = embedding.getNeighborsOfNode(node);
+        countedVarint(neighbors.size());
+        int previous = node;
+        for (int neighbor : neighbors) {
+            countedVarint(zigzag(int64_t(neighbor)-previous));
+            previous = neighbor;
+        }
+    }
+    header.payloadSize = payloadSize;
+    writer.writeAtStart(&header, sizeof(header));
+    return writer.close();
+}
+
+EmbeddingFormat parseEmbeddingFormat(const std::string& name) {
+    if (name == "text") return EmbeddingFormat::Text;
+    if (name == "binary") return EmbeddingFormat::Binary;
+    return EmbeddingFormat::None;
+}
+
+const char* embeddingFileExtension(EmbeddingFormat format) {
+    return format == EmbeddingFormat::Binary ? ".emb" : ".txt";
+}
+
+bool saveEmbedding(const Embedding& embedding, EmbeddingFormat format, const std::string& path) {
+    switch (format) {
+        case EmbeddingFormat::Text: return saveEmbeddingText(embedding, path.data());
+        case EmbeddingFormat::Binary: return saveEmbeddingBinary(embedding, path.data());
+        default: return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef MY_EMBEDDING_WRITER_H
+#define MY_EMBEDDING_WRITER_H
+
+#include <cstdint>
+#include <string>
+
+class Embedding;
+
+enum class EmbeddingFormat { None, Text, Binary };
+
+// writers of rotation systems, streamed from the arrays of the embedding through a fixed
+// buffer (nothing of the size of the embedding is allocated, no OGDF graph is built)
+
+// text: the number of nodes on the first line, then one line per node with its degree
+// followed by its neighbors in rotation order
+bool saveEmbeddingText(const Embedding& embedding, const char* path);
+
+// binary (native little endian): a BinaryEmbeddingHeader, then for each node its degree and
+// its neighbors in rotation order as LEB128 varints, each neighbor as the zigzag encoded
+// difference with the previous one (with the node itself for the first neighbor)
+struct BinaryEmbeddingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t numberOfNodes;
+    uint64_t numberOfHalfEdges;
+    uint64_t payloadSize; // bytes after the header
+};
+
+constexpr char binaryEmbeddingMagic[8] = {'M', 'Y', 'E', 'M', 'B', 'E', 'D', '\0'};
+constexpr uint32_t binaryEmbeddingVersion = 1;
+
+bool saveEmbeddingBinary(const Embedding& embedding, const char* path);
+
+// "text" or "binary", None for anything else
+EmbeddingFormat parseEmbeddingFormat(const std::string& name);
+// ".txt" or ".emb"
+const char* embeddingFileExtension(EmbeddingFormat format);
+// false if the file could not be written (nothing to write for None)
+bool saveEmbedding(const Embedding& embedding, EmbeddingFormat format, const std::string& path);
+
+#endif
\ No newline at end of file
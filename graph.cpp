@@ -1,28 +1,138 @@
 #include "graph.hpp"
 
 #include <iostream>
-#include <list>
+#include <cassert>
 
 #include "utils.hpp"
 
-MyGraph::MyGraph(int numberOfNodes) : numberOfNodes_m(numberOfNodes) {
-    neighborsOfNode_m.resize(numberOfNodes);
-}
+GraphBuilder::GraphBuilder(int numberOfNodes) : numberOfNodes_m(numberOfNodes) {}
 
 // assumes edge is not already in graph
 // adds edge from-to and edge to-from
-void MyGraph::addEdge(int from, int to) {
-    neighborsOfNode_m[from].push_back(to);
-    neighborsOfNode_m[to].push_back(from);
+void GraphBuilder::addEdge(int from, int to) {
+    halfEdges_m.push_back(std::make_pair(from, to));
+    halfEdges_m.push_back(std::make_pair(to, from));
+}
+
+// adds only edge from-to (used by rotation systems, where the order matters)
+void GraphBuilder::addSingleEdge(int from, int to) {
+    halfEdges_m.push_back(std::make_pair(from, to));
+}
+
+void GraphBuilder::reserve(int numberOfHalfEdges) {
+    halfEdges_m.reserve(numberOfHalfEdges);
+}
+
+void GraphBuilder::addNodes(int numberOfNodes) {
+    numberOfNodes_m += numberOfNodes;
+}
+
+int GraphBuilder::size() const {
+    return numberOfNodes_m;
+}
+
+// counting sort of the half edges by their source node,
+// stable so that each neighbor list keeps the insertion order
+// (offsets[node+1] is used as the insertion point of node while filling,
+// so that at the end it is exactly the end of node neighbors)
+void GraphBuilder::build(std::vector<int>& offsets, std::vector<int>& neighbors) const {
+    offsets.assign(numberOfNodes_m+2, 0);
+    for (const auto& [from, to] : halfEdges_m)
+        ++offsets[from+2];
+    for (int node = 0; node < numberOfNodes_m; ++node)
+        offsets[node+2] += offsets[node+1];
+    neighbors.resize(halfEdges_m.size());
+    for (const auto& [from, to] : halfEdges_m)
+        neighbors[offsets[from+1]++] = to;
+    offsets.pop_back();
+}
+
+MyGraph::MyGraph(int numberOfNodes) : numberOfNodes_m(numberOfNodes) {
+    offsets_m.assign(numberOfNodes+1, 0);
+    setViews(*this);
+}
+
+MyGraph::MyGraph(const GraphBuilder& builder) : numberOfNodes_m(builder.size()) {
+    builder.build(offsets_m, neighbors_m);
+    setViews(*this);
+}
+
+MyGraph::MyGraph(int numberOfNodes, std::vector<int>&& offsets, std::vector<int>&& neighbors)
+    : numberOfNodes_m(numberOfNodes), offsets_m(std::move(offsets)), neighbors_m(std::move(neighbors)) {
+    assert(offsets_m.size() == numberOfNodes+1);
+    assert(offsets_m.back() == neighbors_m.size());
+    setViews(*this);
 }
 
-const std::vector<int>& MyGraph::getNeighborsOfNode(int node) const {
-    return neighborsOfNode_m[node];
+MyGraph::MyGraph(int numberOfNodes, std::span<const int> offsets, std::span<const int> neighbors,
+std::shared_ptr<const void> storage)
+    : numberOfNodes_m(numberOfNodes), offsetsView_m(offsets), neighborsView_m(neighbors),
+    externalStorage_m(std::move(storage)) {
+    assert(externalStorage_m != nullptr);
+    assert(offsets.size() == numberOfNodes+1);
+}
+
+MyGraph::MyGraph(const MyGraph& other)
+    : numberOfNodes_m(other.numberOfNodes_m), externalStorage_m(other.externalStorage_m),
+    offsets_m(other.offsets_m), neighbors_m(other.neighbors_m) {
+    setViews(other);
+}
+
+MyGraph::MyGraph(MyGraph&& other) noexcept
+    : numberOfNodes_m(other.numberOfNodes_m), offsetsView_m(other.offsetsView_m),
+    neighborsView_m(other.neighborsView_m), externalStorage_m(std::move(other.externalStorage_m)),
+    offsets_m(std::move(other.offsets_m)), neighbors_m(std::move(other.neighbors_m)) {
+    setViews(*this);
+}
+
+MyGraph& MyGraph::operator=(const MyGraph& other) {
+    if (this == &other) return *this;
+    numberOfNodes_m = other.numberOfNodes_m;
+    externalStorage_m = other.externalStorage_m;
+    offsets_m = other.offsets_m;
+    neighbors_m = other.neighbors_m;
+    setViews(other);
+    return *this;
+}
+
+MyGraph& MyGraph::operator=(MyGraph&& other) noexcept {
+    if (this == &other) return *this;
+    numberOfNodes_m = other.numberOfNodes_m;
+    offsetsView_m = other.offsetsView_m;
+    neighborsView_m = other.neighborsView_m;
+    externalStorage_m = std::move(other.externalStorage_m);
+    offsets_m = std::move(other.offsets_m);
+    neighbors_m = std::move(other.neighbors_m);
+    setViews(*this);
+    return *this;
+}
+
+// owned arrays are viewed from this graph, external ones are shared with other
+void MyGraph::setViews(const MyGraph& other) {
+    if (externalStorage_m != nullptr) {
+        offsetsView_m = other.offsetsView_m;
+        neighborsView_m = other.neighborsView_m;
+        return;
+    }
+    offsetsView_m = offsets_m;
+    neighborsView_m = neighbors_m;
+}
+
+std::span<const int> MyGraph::getNeighborsOfNode(int node) const {
+    return neighborsView_m.subspan(offsetsView_m[node], offsetsView_m[node+1]-offsetsView_m[node]);
+}
+
+std::span<const int> MyGraph::getOffsets() const {
+    return offsetsView_m;
+}
+
+std::span<const int> MyGraph::getNeighbors() const {
+    return neighborsView_m;
 }
 
 void MyGraph::print() const {
     for (int node = 0; node < size(); ++node) {
-        const std::vector<int>& neighbors = getNeighborsOfNode(node);
+        std::span<const int> neighbors = getNeighborsOfNode(node);
         std::cout << "node: " << node << " neighbors: " << neighbors.size() << " ";
         printIterable(neighbors);
     }
@@ -32,6 +142,11 @@ int MyGraph::size() const {
     return numberOfNodes_m;
 }
 
+// counts each undirected edge once
+int MyGraph::numberOfEdges() const {
+    return neighborsView_m.size()/2;
+}
+
 // if the graph is bipartite: returns a vector
 // with 0s and 1s for each node dividing the nodes into two partitions
 const std::optional<std::vector<int>> MyGraph::computeBipartition() const {
@@ -48,13 +163,13 @@ const std::optional<std::vector<int>> MyGraph::computeBipartition() const {
     return bipartition;
 }
 
+// the queue is a vector read from the front, the nodes reached in order
 bool MyGraph::bfsBipartition(int node, std::vector<int>& bipartition) const {
     bipartition[node] = 0;
-    std::list<int> queue{};
+    std::vector<int> queue{};
     queue.push_back(node);
-    while (queue.size() > 0) {
-        node = queue.front();
-        queue.pop_front();
+    for (int next = 0; next < queue.size(); ++next) {
+        node = queue[next];
         for (const int neighbor : getNeighborsOfNode(node)) {
             if (bipartition[neighbor] == -1) {
                 bipartition[neighbor] = 1-bipartition[node];
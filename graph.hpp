@@ -3,23 +3,65 @@
 
 #include <vector>
 #include <optional>
+#include <span>
+#include <utility>
+#include <memory>
 
+// collects the edges of a graph and turns them into the compressed sparse row
+// layout used by MyGraph, neighbors keep the order in which they were added
+class GraphBuilder {
+private:
+    int numberOfNodes_m{};
+    std::vector<std::pair<int, int>> halfEdges_m{};
+
+public:
+    GraphBuilder(int numberOfNodes);
+
+    void addEdge(int from, int to);
+    void addSingleEdge(int from, int to);
+    void reserve(int numberOfHalfEdges);
+    void addNodes(int numberOfNodes);
+    int size() const;
+    void build(std::vector<int>& offsets, std::vector<int>& neighbors) const;
+};
+
+// immutable graph stored in compressed sparse row (CSR) layout:
+// the neighbors of node i are neighbors[offsets[i]] ... neighbors[offsets[i+1]-1]
+// the arrays are either owned (offsets_m and neighbors_m) or external memory
+// (as a memory mapped file) kept alive by externalStorage_m and used without copies
 class MyGraph {
 private:
     int numberOfNodes_m{};
+    std::span<const int> offsetsView_m{};
+    std::span<const int> neighborsView_m{};
+    std::shared_ptr<const void> externalStorage_m{};
 
     bool bfsBipartition(int node, std::vector<int>& bipartition) const;
+    void setViews(const MyGraph& other);
 
 protected:
-    std::vector<std::vector<int>> neighborsOfNode_m{};
+    std::vector<int> offsets_m{};
+    std::vector<int> neighbors_m{};
 
 public:
     MyGraph(int numberOfNodes);
+    MyGraph(const GraphBuilder& builder);
+    // takes the arrays of a graph already in CSR layout
+    MyGraph(int numberOfNodes, std::vector<int>&& offsets, std::vector<int>&& neighbors);
+    // uses arrays in CSR layout that live in the memory owned by storage
+    MyGraph(int numberOfNodes, std::span<const int> offsets, std::span<const int> neighbors,
+        std::shared_ptr<const void> storage);
+    MyGraph(const MyGraph& other);
+    MyGraph(MyGraph&& other) noexcept;
+    MyGraph& operator=(const MyGraph& other);
+    MyGraph& operator=(MyGraph&& other) noexcept;
 
-    void addEdge(int from, int to);
-    const std::vector<int>& getNeighborsOfNode(int node) const;
+    std::span<const int> getNeighborsOfNode(int node) const;
+    std::span<const int> getOffsets() const;
+    std::span<const int> getNeighbors() const;
     virtual void print() const;
     int size() const;
+    int numberOfEdges() const;
     const std::optional<std::vector<int>> computeBipartition() const;
 };
 
@@ -0,0 +1,297 @@
+#include "graphGenerator.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <array>
+#include <deque>
+#include <utility>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    using Edges = std::vector<std::pair<int, int>>;
+
+    uint64_t edgeKey(int from, int to) {
+        return uint64_t(uint32_t(from)) << 32 | uint32_t(to);
+    }
+
+    MyGraph shuffledGraph(int numberOfNodes, Edges& edges, std::mt19937_64& random) {
+        std::vector<int> label(numberOfNodes);
+        std::iota(label.begin(), label.end(), 0);
+        std::shuffle(label.begin(), label.end(), random);
+        std::shuffle(edges.begin(), edges.end(), random);
+        GraphBuilder builder(numberOfNodes);
+        builder.reserve(2*edges.size());
+        for (const auto& [from, to] : edges)
+            builder.addEdge(label[from], label[to]);
+        return MyGraph(builder);
+    }
+
+    // triangulation grown by inserting each new node in a random face, faces are
+    // kept oriented to allow edge flips afterwards
+    class Triangulation {
+    public:
+        std::vector<std::array<int, 3>> faces{};
+        int numberOfNodes{3};
+
+        Triangulation() {
+            faces.push_back({0, 1, 2});
+            faces.push_back({0, 2, 1});
+        }
+
+        void insertNode(int face) {
+            auto [a, b, c] = faces[face];
+            int node = numberOfNodes++;
+            faces[face] = {a, b, node};
+            faces.push_back({b, c, node});
+            faces.push_back({c, a, node});
+        }
+
+        // flips random edges: the result is far from the stacked structure of the insertions
+        void flipEdges(int numberOfFlips, std::mt19937_64& random) {
+            std::unordered_map<uint64_t, int> faceOfEdge{};
+            std::unordered_set<uint64_t> edges{};
+            for (int face = 0; face < faces.size(); ++face) {
+                for (int i = 0; i < 3; ++i) {
+                    int from = faces[face][i];
+                    int to = faces[face][(i+1)%3];
+                    faceOfEdge[edgeKey(from, to)] = face;
+                    edges.insert(edgeKey(std::min(from, to), std::max(from, to)));
+                }
+            }
+            for (int flip = 0; flip < numberOfFlips; ++flip) {
+                int face = std::uniform_int_distribution<int>(0, faces.size()-1)(random);
+                int side = std::uniform_int_distribution<int>(0, 2)(random);
+                int a = faces[face][side];
+                int b = faces[face][(side+1)%3];
+                int c = faces[face][(side+2)%3];
+                int otherFace = faceOfEdge[edgeKey(b, a)];
+                int d = -1;
+                for (int i = 0; i < 3; ++i)
+                    if (faces[otherFace][i] != a && faces[otherFace][i] != b) d = faces[otherFace][i];
+                if (c == d || edges.count(edgeKey(std::min(c, d), std::max(c, d)))) continue;
+                // faces (a, b, c) and (b, a, d) become (a, d, c) and (d, b, c)
+                edges.erase(edgeKey(std::min(a, b), std::max(a, b)));
+                edges.insert(edgeKey(std::min(c, d), std::max(c, d)));
+                faceOfEdge.erase(edgeKey(a, b));
+                faceOfEdge.erase(edgeKey(b, a));
+                faces[face] = {a, d, c};
+                faces[otherFace] = {d, b, c};
+                faceOfEdge[edgeKey(a, d)] = face;
+                faceOfEdge[edgeKey(d, c)] = face;
+                faceOfEdge[edgeKey(c, a)] = face;
+                faceOfEdge[edgeKey(d, b)] = otherFace;
+                faceOfEdge[edgeKey(b, c)] = otherFace;
+                faceOfEdge[edgeKey(c, d)] = otherFace;
+            }
+        }
+
+        // each edge once
+        Edges getEdges() const {
+            Edges edges{};
+            for (const auto& face : faces)
+                for (int i = 0; i < 3; ++i)
+                    if (face[i] < face[(i+1)%3]) edges.push_back({face[i], face[(i+1)%3]});
+            return edges;
+        }
+    };
+
+    // random planar graph with about 2.4n edges (a triangulation without a fifth of its edges)
+    Edges sparsePlanarEdges(int numberOfNodes, std::mt19937_64& random) {
+        Triangulation triangulation{};
+        while (triangulation.numberOfNodes < numberOfNodes) {
+            int face = std::uniform_int_distribution<int>(0, triangulation.faces.size()-1)(random);
+            triangulation.insertNode(face);
+        }
+        triangulation.flipEdges(2*numberOfNodes, random);
+        Edges edges = triangulation.getEdges();
+        std::shuffle(edges.begin(), edges.end(), random);
+        edges.resize(edges.size()*4/5);
+        return edges;
+    }
+
+    // paths of new nodes (after the first numberOfNodes) between the given pairs of
+    // branch nodes, pathLength nodes each
+    void addSubdividedEdges(int& numberOfNodes, const std::vector<int>& branchNodes,
+    const std::vector<std::pair<int, int>>& pairs, int pathLength, Edges& edges) {
+        for (const auto& [first, second] : pairs) {
+            int prev = branchNodes[first];
+            for (int i = 0; i < pathLength; ++i) {
+                edges.push_back({prev, numberOfNodes});
+                prev = numberOfNodes++;
+            }
+            edges.push_back({prev, branchNodes[second]});
+        }
+    }
+
+    MyGraph subdividedKuratowski(int numberOfNodes, bool isK5, std::mt19937_64& random) {
+        int numberOfBranchNodes = isK5 ? 5 : 6;
+        std::vector<std::pair<int, int>> pairs{};
+        for (int i = 0; i < numberOfBranchNodes; ++i)
+            for (int j = i+1; j < numberOfBranchNodes; ++j)
+                if (isK5 || (i < 3 && j >= 3)) pairs.push_back({i, j});
+        int pathLength = std::max(1, int(std::sqrt(double(numberOfNodes))));
+        int hostNodes = std::max(numberOfBranchNodes+3, numberOfNodes-int(pairs.size())*pathLength);
+        Edges edges = sparsePlanarEdges(hostNodes, random);
+        std::vector<int> branchNodes(hostNodes);
+        std::iota(branchNodes.begin(), branchNodes.end(), 0);
+        std::shuffle(branchNodes.begin(), branchNodes.end(), random);
+        branchNodes.resize(numberOfBranchNodes);
+        int totalNodes = hostNodes;
+        addSubdividedEdges(totalNodes, branchNodes, pairs, pathLength, edges);
+        return shuffledGraph(totalNodes, edges, random);
+    }
+}
+
+GraphGenerator::GraphGenerator(uint64_t seed) : seed_m(seed) {}
+
+const std::vector<std::string>& GraphGenerator::getFamilies() {
+    static const std::vector<std::string> families{"grid", "triangulation", "wheel", "apollonian",
+        "chordCycle", "blocks", "subdividedK5", "subdividedK33"};
+    return families;
+}
+
+bool GraphGenerator::isPlanarFamily(const std::string& family) {
+    return family != "subdividedK5" && family != "subdividedK33";
+}
+
+MyGraph GraphGenerator::generate(const std::string& family, int numberOfNodes) const {
+    if (family == "grid") return grid(numberOfNodes);
+    if (family == "triangulation") return triangulation(numberOfNodes);
+    if (family == "wheel") return wheel(numberOfNodes);
+    if (family == "apollonian") return apollonian(numberOfNodes);
+    if (family == "chordCycle") return chordCycle(numberOfNodes);
+    if (family == "blocks") return blocks(numberOfNodes);
+    if (family == "subdividedK5") return subdividedK5(numberOfNodes);
+    assert(family == "subdividedK33");
+    return subdividedK33(numberOfNodes);
+}
+
+// square grid, side rounded down
+MyGraph GraphGenerator::grid(int numberOfNodes) const {
+    std::mt19937_64 random(seed_m);
+    int side = std::max(2, int(std::sqrt(double(numberOfNodes))));
+    Edges edges{};
+    for (int row = 0; row < side; ++row) {
+        for (int column = 0; column < side; ++column) {
+            int node = row*side+column;
+            if (column+1 < side) edges.push_back({node, node+1});
+            if (row+1 < side) edges.push_back({node, node+side});
+        }
+    }
+    return shuffledGraph(side*side, edges, random);
+}
+
+// random maximal planar graph: random insertions in faces, then random edge flips
+MyGraph GraphGenerator::triangulation(int numberOfNodes) const {
+    std::mt19937_64 random(seed_m);
+    Triangulation triangulation{};
+    while (triangulation.numberOfNodes < std::max(4, numberOfNodes)) {
+        int face = std::uniform_int_distribution<int>(0, triangulation.faces.size()-1)(random);
+        triangulation.insertNode(face);
+    }
+    triangulation.flipEdges(2*triangulation.numberOfNodes, random);
+    Edges edges = triangulation.getEdges();
+    return shuffledGraph(triangulation.numberOfNodes, edges, random);
+}
+
+MyGraph GraphGenerator::wheel(int numberOfNodes) const {
+    std::mt19937_64 random(seed_m);
+    int rim = std::max(3, numberOfNodes-1);
+    Edges edges{};
+    for (int node = 1; node <= rim; ++node) {
+        edges.push_back({0, node});
+        edges.push_back({node, node % rim + 1});
+    }
+    return shuffledGraph(rim+1, edges, random);
+}
+
+// faces are split level by level (breadth first), the last level only partially
+MyGraph GraphGenerator::apollonian(int numberOfNodes) const {
+    std::mt19937_64 random(seed_m);
+    Triangulation triangulation{};
+    std::deque<int> queue{0, 1};
+    while (triangulation.numberOfNodes < std::max(4, numberOfNodes)) {
+        int face = queue.front();
+        queue.pop_front();
+        triangulation.insertNode(face);
+        // the split face keeps its index, the other two are appended
+        queue.push_back(face);
+        queue.push_back(triangulation.faces.size()-2);
+        queue.push_back(triangulation.faces.size()-1);
+    }
+    Edges edges = triangulation.getEdges();
+    return shuffledGraph(triangulation.numberOfNodes, edges, random);
+}
+
+// a cycle with a random triangulation of the polygon inside
+// and a random half of another one outside: about 2.5n edges, n/2 segments per level
+MyGraph GraphGenerator::chordCycle(int numberOfNodes) const {
+    std::mt19937_64 random(seed_m);
+    int n = std::max(4, numberOfNodes);
+    Edges edges{};
+    for (int node = 0; node < n; ++node)
+        edges.push_back({node, (node+1) % n});
+    for (int side = 0; side < 2; ++side) {
+        std::vector<std::pair<int, int>> intervals{{0, n-1}};
+        while (!intervals.empty()) {
+            auto [from, to] = intervals.back();
+            intervals.pop_back();
+            if (to-from < 2) continue;
+            int middle = std::uniform_int_distribution<int>(from+1, to-1)(random);
+            bool isAdded = side == 0 || std::uniform_int_distribution<int>(0, 1)(random) == 0;
+            if (middle-from > 1 && isAdded) edges.push_back({from, middle});
+            if (to-middle > 1 && isAdded) edges.push_back({middle, to});
+            intervals.push_back({from, middle});
+            intervals.push_back({middle, to});
+        }
+    }
+    // (0, n-1) is a cycle edge, it must not be added again as a chord
+    std::sort(edges.begin(), edges.end(), [](auto a, auto b) {
+        return std::minmax(a.first, a.second) < std::minmax(b.first, b.second);
+    });
+    edges.erase(std::unique(edges.begin(), edges.end(), [](auto a, auto b) {
+        return std::minmax(a.first, a.second) == std::minmax(b.first, b.second);
+    }), edges.end());
+    return shuffledGraph(n, edges, random);
+}
+
+// tree of small blocks (wheels, cycles and K4s) glued at random nodes
+MyGraph GraphGenerator::blocks(int numberOfNodes) const {
+    std::mt19937_64 random(seed_m);
+    Edges edges{};
+    int n = 1;
+    while (n < numberOfNodes) {
+        int cutNode = std::uniform_int_distribution<int>(0, n-1)(random);
+        int kind = std::uniform_int_distribution<int>(0, 2)(random);
+        int size = kind == 2 ? 4 : std::uniform_int_distribution<int>(4, 12)(random);
+        std::vector<int> nodes{cutNode};
+        for (int i = 1; i < size; ++i) nodes.push_back(n++);
+        if (kind == 2) { // K4
+            for (int i = 0; i < 4; ++i)
+                for (int j = i+1; j < 4; ++j) edges.push_back({nodes[i], nodes[j]});
+            continue;
+        }
+        // cycle through all the nodes, or a wheel with the cut node as hub
+        int first = kind == 0 ? 0 : 1;
+        for (int i = first; i < size; ++i) {
+            int next = i+1 < size ? i+1 : first;
+            edges.push_back({nodes[i], nodes[next]});
+            if (kind == 1) edges.push_back({nodes[0], nodes[i]});
+        }
+    }
+    return shuffledGraph(n, edges, random);
+}
+
+MyGraph GraphGenerator::subdividedK5(int numberOfNodes) const {
+    std::mt19937_64 random(seed_m);
+    return subdividedKuratowski(numberOfNodes, true, random);
+}
+
+MyGraph GraphGenerator::subdividedK33(int numberOfNodes) const {
+    std::mt19937_64 random(seed_m);
+    return subdividedKuratowski(numberOfNodes, false, random);
+}
\ No newline at end of file
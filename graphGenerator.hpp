@@ -0,0 +1,35 @@
+#ifndef MY_GRAPH_GENERATOR_H
+#define MY_GRAPH_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graph.hpp"
+
+// synthetic graphs with about numberOfNodes nodes for benchmarks: nodes are relabeled
+// and edges shuffled (with seed) so that no family gets a favourable input order
+class GraphGenerator {
+private:
+    uint64_t seed_m{};
+
+public:
+    GraphGenerator(uint64_t seed);
+
+    static const std::vector<std::string>& getFamilies();
+    static bool isPlanarFamily(const std::string& family);
+    MyGraph generate(const std::string& family, int numberOfNodes) const;
+
+    // planar
+    MyGraph grid(int numberOfNodes) const;
+    MyGraph triangulation(int numberOfNodes) const;
+    MyGraph wheel(int numberOfNodes) const;
+    MyGraph apollonian(int numberOfNodes) const;
+    MyGraph chordCycle(int numberOfNodes) const;
+    MyGraph blocks(int numberOfNodes) const;
+    // non planar: long subdivided K5 or K3,3 paths between nodes of a planar graph
+    MyGraph subdividedK5(int numberOfNodes) const;
+    MyGraph subdividedK33(int numberOfNodes) const;
+};
+
+#endif
\ No newline at end of file
@@ -1,31 +1,209 @@
 #include "graphLoader.hpp"
 
-#include <fstream>
-#include <iostream>
-#include <utility>
-#include <string>
-#include <sstream>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
 
 #include "graph.hpp"
+#include "mappedFile.hpp"
+#include "binaryGraph.hpp"
+#include "threadPool.hpp"
 
-const MyGraph GraphLoader::loadFromFile(char* path) {
-    std::ifstream inputFile(path);
-    if (!inputFile.is_open()) {
-        std::cerr << "Error: Could not open file " << path << std::endl;
-        exit(1);
-    }
-    int nodesNumber{};
-    inputFile >> nodesNumber;
-    MyGraph graph(nodesNumber);
-    int from, to;
-    std::string line;
-    while (std::getline(inputFile, line)) {
-        if (line.find("//") == 0)
-            continue;
-        std::istringstream iss(line);
-        if (iss >> from >> to)
-            graph.addEdge(from, to);
-    }
-    inputFile.close();
+namespace {
+    // smaller files are parsed by a single thread
+    constexpr size_t minChunkSize = size_t(1) << 20;
+
+    bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // parses the integer after cursor (blanks are skipped) and moves cursor past it
+    bool parseInt(const char*& cursor, const char* end, int& value) {
+        while (cursor < end && isBlank(*cursor)) ++cursor;
+        if (cursor+1 < end && *cursor == '+' && *(cursor+1) >= '0' && *(cursor+1) <= '9') ++cursor;
+        auto [next, error] = std::from_chars(cursor, end, value);
+        if (error != std::errc()) return false;
+        cursor = next;
+        return true;
+    }
+
+    // calls addEdge(from, to) for each edge line in [begin, end), anything after the two nodes
+    // is ignored, like lines that do not start with two integers
+    template <typename AddEdge>
+    void parseLines(const char* begin, const char* end, AddEdge addEdge) {
+        const char* line = begin;
+        while (line < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end-line));
+            if (lineEnd == nullptr) lineEnd = end;
+            bool isComment = lineEnd-line >= 2 && line[0] == '/' && line[1] == '/';
+            int from, to;
+            const char* cursor = line;
+            if (!isComment && parseInt(cursor, lineEnd, from) && parseInt(cursor, lineEnd, to))
+                addEdge(from, to);
+            line = lineEnd+1;
+        }
+    }
+
+    // the number of nodes is the first integer of the file, the rest of its line is a normal line
+    const char* parseHeader(const char* begin, const char* end, int& numberOfNodes) {
+        numberOfNodes = 0;
+        const char* cursor = begin;
+        while (cursor < end && (isBlank(*cursor) || *cursor == '\n')) ++cursor;
+        if (!parseInt(cursor, end, numberOfNodes)) return end;
+        return cursor;
+    }
+
+    // chunks start at the beginning of a line (except the first one)
+    std::vector<const char*> splitAtLines(const char* begin, const char* end, int numberOfChunks) {
+        std::vector<const char*> bounds{begin};
+        for (int i = 1; i < numberOfChunks; ++i) {
+            const char* bound = std::max(bounds.back(), begin+(end-begin)/numberOfChunks*i);
+            const char* newline = static_cast<const char*>(std::memchr(bound, '\n', end-bound));
+            bounds.push_back(newline == nullptr ? end : newline+1);
+        }
+        bounds.push_back(end);
+        return bounds;
+    }
+}
+
+GraphLoader::GraphLoader(int numberOfThreads) {
+    if (numberOfThreads > 1)
+        threadPool_m = std::make_unique<ThreadPool>(numberOfThreads);
+}
+
+GraphLoader::~GraphLoader() = default;
+
+void GraphLoader::setBinaryVerification(bool isEnabled) {
+    isBinaryVerificationEnabled_m = isEnabled;
+}
+
+// offsets has two extra slots while filling: degrees are counted in offsets[node+2], so that
+// after the prefix sums offsets[node+1] is the start of node and can be used as its insertion
+// point, ending as its end (as in GraphBuilder::build)
+std::optional<MyGraph> GraphLoader::loadFromFile(const char* path, const char*& error) {
+    error = nullptr;
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const MappedFile> mappedFile = std::make_shared<const MappedFile>(path);
+    const MappedFile& file = *mappedFile;
+    if (!file.isOpen()) {
+        error = "Could not open file";
+        return std::nullopt;
+    }
+    lastFileSize_m = file.size();
+    if (hasBinaryGraphMagic(file.data(), file.size())) {
+        error = checkBinaryGraph(file, isBinaryVerificationEnabled_m);
+        if (error != nullptr) return std::nullopt;
+        MyGraph graph = viewBinaryGraph(std::move(mappedFile));
+        lastLoadTime_m = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+        return graph;
+    }
+    file.adviseSequential();
+    const char* end = file.data()+file.size();
+    int numberOfNodes{};
+    const char* begin = parseHeader(file.data(), end, numberOfNodes);
+    if (numberOfNodes < 0) {
+        error = "Negative number of nodes in file";
+        return std::nullopt;
+    }
+    int numberOfChunks = 1;
+    if (threadPool_m && end-begin >= 2*minChunkSize)
+        numberOfChunks = std::min<size_t>(4*threadPool_m->size(), (end-begin)/minChunkSize);
+    const std::vector<const char*> bounds = splitAtLines(begin, end, numberOfChunks);
+    std::vector<int> offsets(numberOfNodes+2, 0);
+    std::vector<int> edgesInChunk(numberOfChunks+1, 0);
+    std::atomic<bool> isOutOfRange{false};
+    auto isValid = [&](int from, int to) {
+        if (from >= 0 && from < numberOfNodes && to >= 0 && to < numberOfNodes) return true;
+        isOutOfRange.store(true, std::memory_order_relaxed);
+        return false;
+    };
+    std::vector<int> neighbors{};
+    if (numberOfChunks == 1) {
+        parseLines(begin, end, [&](int from, int to) {
+            if (!isValid(from, to)) return;
+            ++offsets[from+2];
+            ++offsets[to+2];
+            ++edgesInChunk[1];
+        });
+        if (isOutOfRange) {
+            error = "Node out of range in file";
+            return std::nullopt;
+        }
+        for (int node = 0; node < numberOfNodes; ++node)
+            offsets[node+2] += offsets[node+1];
+        neighbors.resize(2*size_t(edgesInChunk[1]));
+        parseLines(begin, end, [&](int from, int to) {
+            neighbors[offsets[from+1]++] = to;
+            neighbors[offsets[to+1]++] = from;
+        });
+    }
+    else {
+        // with several chunks the neighbors are placed in any order, tagged by the index
+        // of their edge in the file, and then sorted node by node
+        for (int chunk = 0; chunk < numberOfChunks; ++chunk) {
+            threadPool_m->submit([&, chunk](int) {
+                int edges = 0;
+                parseLines(bounds[chunk], bounds[chunk+1], [&](int from, int to) {
+                    if (!isValid(from, to)) return;
+                    std::atomic_ref<int>(offsets[from+2]).fetch_add(1, std::memory_order_relaxed);
+                    std::atomic_ref<int>(offsets[to+2]).fetch_add(1, std::memory_order_relaxed);
+                    ++edges;
+                });
+                edgesInChunk[chunk+1] = edges;
+            });
+        }
+        threadPool_m->wait();
+        if (isOutOfRange) {
+            error = "Node out of range in file";
+            return std::nullopt;
+        }
+        for (int node = 0; node < numberOfNodes; ++node)
+            offsets[node+2] += offsets[node+1];
+        for (int chunk = 0; chunk < numberOfChunks; ++chunk)
+            edgesInChunk[chunk+1] += edgesInChunk[chunk];
+        std::vector<uint64_t> taggedNeighbors(2*size_t(edgesInChunk[numberOfChunks]));
+        for (int chunk = 0; chunk < numberOfChunks; ++chunk) {
+            threadPool_m->submit([&, chunk](int) {
+                uint64_t edge = edgesInChunk[chunk];
+                parseLines(bounds[chunk], bounds[chunk+1], [&](int from, int to) {
+                    int fromIndex = std::atomic_ref<int>(offsets[from+1]).fetch_add(1, std::memory_order_relaxed);
+                    int toIndex = std::atomic_ref<int>(offsets[to+1]).fetch_add(1, std::memory_order_relaxed);
+                    taggedNeighbors[fromIndex] = edge << 32 | uint32_t(to);
+                    taggedNeighbors[toIndex] = edge << 32 | uint32_t(from);
+                    ++edge;
+                });
+            });
+        }
+        threadPool_m->wait();
+        neighbors.resize(taggedNeighbors.size());
+        for (int chunk = 0; chunk < numberOfChunks; ++chunk) {
+            threadPool_m->submit([&, chunk](int) {
+                int firstNode = int64_t(numberOfNodes)*chunk/numberOfChunks;
+                int lastNode = int64_t(numberOfNodes)*(chunk+1)/numberOfChunks;
+                for (int node = firstNode; node < lastNode; ++node) {
+                    std::sort(taggedNeighbors.begin()+offsets[node], taggedNeighbors.begin()+offsets[node+1]);
+                    for (int i = offsets[node]; i < offsets[node+1]; ++i)
+                        neighbors[i] = int(uint32_t(taggedNeighbors[i]));
+                }
+            });
+        }
+        threadPool_m->wait();
+    }
+    offsets.pop_back();
+    MyGraph graph(numberOfNodes, std::move(offsets), std::move(neighbors));
+    lastLoadTime_m = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
     return graph;
+}
+
+size_t GraphLoader::getLastFileSize() const {
+    return lastFileSize_m;
+}
+
+double GraphLoader::getLastThroughput() const {
+    if (lastLoadTime_m <= 0) return 0;
+    return lastFileSize_m/(1024.0*1024.0)/(lastLoadTime_m/1000.0);
 }
\ No newline at end of file
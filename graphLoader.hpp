@@ -1,11 +1,39 @@
 #ifndef MY_GRAPH_LOADER_H
 #define MY_GRAPH_LOADER_H
 
-class MyGraph;
+#include <memory>
+#include <optional>
+#include <cstddef>
 
+#include "graph.hpp"
+
+class ThreadPool;
+
+// text format: number of nodes, then one edge "from to" per line,
+// lines starting with // are comments
+// the file is memory mapped and parsed in place: chunks of lines are parsed in parallel
+// twice, first counting the degrees and then filling the neighbors directly in the
+// graph, neighbors are in file order as with a GraphBuilder
+// binary graph files (see binaryGraph.hpp) are recognized and used without parsing
 class GraphLoader {
+private:
+    std::unique_ptr<ThreadPool> threadPool_m{};
+    bool isBinaryVerificationEnabled_m{false};
+    size_t lastFileSize_m{0};
+    double lastLoadTime_m{0}; // milliseconds
+
 public:
-    const MyGraph loadFromFile(char* path);
+    GraphLoader(int numberOfThreads = 1);
+    ~GraphLoader();
+
+    // binary files are checked completely, not only their header
+    void setBinaryVerification(bool isEnabled);
+    // nullopt if the file cannot be read or is not a valid graph, with error set to the reason
+    // (error is null otherwise)
+    std::optional<MyGraph> loadFromFile(const char* path, const char*& error);
+    size_t getLastFileSize() const;
+    // MB/s of the last file loaded
+    double getLastThroughput() const;
 };
 
 #endif
\ No newline at end of file
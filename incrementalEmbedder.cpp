@@ -0,0 +1,523 @@
+#include "incrementalEmbedder.hpp"
+
+#include <cassert>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include "biconnectedComponent.hpp"
+#include "dartIndex.hpp"
+
+IncrementalEmbedder::IncrementalEmbedder(int numberOfNodes) {
+    firstDart_m.assign(numberOfNodes, -1);
+    componentParent_m.resize(numberOfNodes);
+    std::iota(componentParent_m.begin(), componentParent_m.end(), 0);
+    componentSize_m.assign(numberOfNodes, 1);
+    parentBlock_m.assign(numberOfNodes, -1);
+    localNode_m.assign(numberOfNodes, -1);
+    dartTo_m.assign(numberOfNodes, -1);
+}
+
+// the blocks are hung from each other by a breadth first search from the first node of
+// each connected component; the block of each edge is then the parent block of both its
+// ends, or the parent block of the end that is not the head of that block
+IncrementalEmbedder::IncrementalEmbedder(const Embedding& embedding) : IncrementalEmbedder(embedding.size()) {
+    DartIndex darts(embedding);
+    std::vector<int> dartOf(darts.numberOfDarts(), -1);
+    for (int dart = 0; dart < darts.numberOfDarts(); ++dart) {
+        if (dartOf[dart] != -1) continue;
+        int edge = newEdge(darts.getTail(dart), darts.getHead(dart));
+        dartOf[dart] = 2*edge;
+        dartOf[darts.getTwin(dart)] = 2*edge+1;
+    }
+    std::span<const int> offsets = embedding.getOffsets();
+    for (int node = 0; node < embedding.size(); ++node) {
+        for (int i = offsets[node]; i < offsets[node+1]; ++i)
+            insertDartBefore(dartOf[i], node, firstDart_m[node]);
+    }
+    for (int dart = 0; dart < head_m.size(); ++dart) {
+        if (face_m[dart] != -1) continue;
+        int face = newFace(0);
+        labelFace(dart, face);
+    }
+    EmbedderWorkspace workspace{};
+    BiconnectedComponentsHandler handler(embedding, workspace);
+    const std::vector<Component>& blocks = handler.getComponents();
+    std::vector<std::vector<int>> blocksOfNode(embedding.size());
+    for (int block = 0; block < blocks.size(); ++block)
+        for (int node = 0; node < blocks[block].size(); ++node)
+            blocksOfNode[blocks[block].getLabelOfNode(node)].push_back(block);
+    numberOfBlocks_m = blocks.size();
+    blockParent_m.resize(blocks.size());
+    std::iota(blockParent_m.begin(), blockParent_m.end(), 0);
+    blockHead_m.assign(blocks.size(), -1);
+    blockEdges_m.resize(blocks.size());
+    std::vector<bool> isVisited(embedding.size(), false);
+    std::vector<int> queue{};
+    for (int root = 0; root < embedding.size(); ++root) {
+        if (isVisited[root]) continue;
+        isVisited[root] = true;
+        queue.assign(1, root);
+        for (int i = 0; i < queue.size(); ++i) {
+            int node = queue[i];
+            for (int block : blocksOfNode[node]) {
+                if (blockHead_m[block] != -1) continue;
+                blockHead_m[block] = node;
+                for (int j = 0; j < blocks[block].size(); ++j) {
+                    int other = blocks[block].getLabelOfNode(j);
+                    if (isVisited[other]) continue;
+                    isVisited[other] = true;
+                    parentBlock_m[other] = block;
+                    queue.push_back(other);
+                }
+            }
+        }
+    }
+    for (int edge = 0; edge < numberOfEdges(); ++edge) {
+        int from = head_m[2*edge+1];
+        int to = head_m[2*edge];
+        int fromBlock = parentBlock_m[from];
+        int toBlock = parentBlock_m[to];
+        int block = fromBlock != -1 && fromBlock == toBlock ? fromBlock : toBlock != -1 && blockHead_m[toBlock] == from ? toBlock : fromBlock;
+        assert(block != -1 && (block == toBlock || blockHead_m[block] == to));
+        blockOfEdge_m[edge] = block;
+        blockEdges_m[block].push_back(edge);
+        int fromComponent = findComponent(from);
+        int toComponent = findComponent(to);
+        if (fromComponent == toComponent) continue;
+        if (componentSize_m[fromComponent] < componentSize_m[toComponent]) std::swap(fromComponent, toComponent);
+        componentParent_m[toComponent] = fromComponent;
+        componentSize_m[fromComponent] += componentSize_m[toComponent];
+    }
+}
+
+int IncrementalEmbedder::findComponent(int node) {
+    while (componentParent_m[node] != node) {
+        componentParent_m[node] = componentParent_m[componentParent_m[node]];
+        node = componentParent_m[node];
+    }
+    return node;
+}
+
+int IncrementalEmbedder::findBlock(int block) {
+    while (blockParent_m[block] != block) {
+        blockParent_m[block] = blockParent_m[blockParent_m[block]];
+        block = blockParent_m[block];
+    }
+    return block;
+}
+
+int IncrementalEmbedder::getParentBlock(int node) {
+    return parentBlock_m[node] == -1 ? -1 : findBlock(parentBlock_m[node]);
+}
+
+// dart 2e goes from from to to, it is not in any rotation yet
+int IncrementalEmbedder::newEdge(int from, int to) {
+    int edge = numberOfEdges();
+    head_m.push_back(to);
+    head_m.push_back(from);
+    nextAround_m.resize(head_m.size(), -1);
+    prevAround_m.resize(head_m.size(), -1);
+    face_m.resize(head_m.size(), -1);
+    blockOfEdge_m.push_back(-1);
+    return edge;
+}
+
+// before is a dart leaving tail, or -1 if tail has none
+void IncrementalEmbedder::insertDartBefore(int dart, int tail, int before) {
+    if (before == -1) {
+        firstDart_m[tail] = dart;
+        nextAround_m[dart] = prevAround_m[dart] = dart;
+        return;
+    }
+    int after = prevAround_m[before];
+    nextAround_m[after] = dart;
+    prevAround_m[dart] = after;
+    nextAround_m[dart] = before;
+    prevAround_m[before] = dart;
+}
+
+// as DartIndex: the dart after the twin in the rotation around the head
+int IncrementalEmbedder::nextInFace(int dart) const {
+    return nextAround_m[dart^1];
+}
+
+int IncrementalEmbedder::newFace(int size) {
+    faceSize_m.push_back(size);
+    ++numberOfFaces_m;
+    return faceSize_m.size()-1;
+}
+
+// all the darts of the face of start
+void IncrementalEmbedder::labelFace(int start, int face) {
+    int dart = start;
+    do {
+        face_m[dart] = face;
+        ++faceSize_m[face];
+        dart = nextInFace(dart);
+    } while (dart != start);
+}
+
+// the tree of blocks of the smaller component is re-rooted at its end of the edge, which
+// then hangs from the new block (the edge); the faces of the two ends around which the
+// edge is inserted become one face, with the id of the bigger one
+void IncrementalEmbedder::joinComponents(int from, int to) {
+    int fromComponent = findComponent(from);
+    int toComponent = findComponent(to);
+    if (componentSize_m[fromComponent] < componentSize_m[toComponent]) {
+        std::swap(from, to);
+        std::swap(fromComponent, toComponent);
+    }
+    componentParent_m[toComponent] = fromComponent;
+    componentSize_m[fromComponent] += componentSize_m[toComponent];
+    evert(to);
+    int edge = newEdge(from, to);
+    int block = blockParent_m.size();
+    blockParent_m.push_back(block);
+    blockHead_m.push_back(from);
+    blockEdges_m.push_back({edge});
+    blockOfEdge_m[edge] = block;
+    parentBlock_m[to] = block;
+    ++numberOfBlocks_m;
+    struct Part {
+        int face;
+        int start;
+        int end;
+    };
+    int fromDart = firstDart_m[from];
+    int toDart = firstDart_m[to];
+    Part parts[2] = {{fromDart == -1 ? -1 : face_m[fromDart], fromDart, 2*edge},
+                     {toDart == -1 ? -1 : face_m[toDart], toDart, 2*edge+1}};
+    insertDartBefore(2*edge, from, fromDart);
+    insertDartBefore(2*edge+1, to, toDart);
+    if (parts[0].face == -1 || (parts[1].face != -1 && faceSize_m[parts[1].face] > faceSize_m[parts[0].face]))
+        std::swap(parts[0], parts[1]);
+    int face = parts[0].face == -1 ? newFace(0) : parts[0].face;
+    if (parts[1].face != -1) {
+        // the darts of the smaller face, from its first dart to the new edge
+        for (int dart = parts[1].start; dart != parts[1].end; dart = nextInFace(dart))
+            face_m[dart] = face;
+        faceSize_m[face] += faceSize_m[parts[1].face];
+        --numberOfFaces_m;
+    }
+    face_m[2*edge] = face_m[2*edge+1] = face;
+    faceSize_m[face] += 2;
+}
+
+// reverses the path from node to the root of its tree of blocks
+void IncrementalEmbedder::evert(int node) {
+    int previous = node;
+    int block = getParentBlock(node);
+    parentBlock_m[node] = -1;
+    while (block != -1) {
+        int next = blockHead_m[block];
+        int nextBlock = getParentBlock(next);
+        blockHead_m[block] = previous;
+        parentBlock_m[next] = block;
+        previous = next;
+        block = nextBlock;
+    }
+}
+
+// a dart leaving each end such that the corners before them are on the same face
+bool IncrementalEmbedder::findCommonFace(int from, int to, int& fromDart, int& toDart) {
+    if (firstDart_m[from] == -1 || firstDart_m[to] == -1) return false;
+    faceMarks_m.reset(faceSize_m.size());
+    int dart = firstDart_m[from];
+    do {
+        faceMarks_m.mark(face_m[dart]);
+        dart = nextAround_m[dart];
+    } while (dart != firstDart_m[from]);
+    toDart = firstDart_m[to];
+    while (!faceMarks_m.isMarked(face_m[toDart])) {
+        toDart = nextAround_m[toDart];
+        if (toDart == firstDart_m[to]) return false;
+    }
+    fromDart = firstDart_m[from];
+    while (face_m[fromDart] != face_m[toDart])
+        fromDart = nextAround_m[fromDart];
+    return true;
+}
+
+// the two faces of the new edge are walked together until one is closed:
+// its darts get a new id, the other one keeps the id of the face that was split
+void IncrementalEmbedder::splitFace(int edge) {
+    int oldFace = face_m[nextAround_m[2*edge]];
+    int walkers[2] = {2*edge, 2*edge+1};
+    int lengths[2] = {0, 0};
+    int smaller = -1;
+    while (smaller == -1) {
+        for (int i = 0; i < 2 && smaller == -1; ++i) {
+            walkers[i] = nextInFace(walkers[i]);
+            ++lengths[i];
+            if (walkers[i] == 2*edge+i) smaller = i;
+        }
+    }
+    int face = newFace(0);
+    labelFace(2*edge+smaller, face);
+    face_m[2*edge+1-smaller] = oldFace;
+    faceSize_m[oldFace] += 2-lengths[smaller];
+}
+
+// blocks on the path between the two nodes in the forest of blocks, climbing from both ends
+// in turns (so in time linear in the length of the path) until one meets the other's path;
+// top is the node from which the merged block will hang
+std::vector<int> IncrementalEmbedder::findBlocksBetween(int from, int to, int& top) {
+    std::vector<int> paths[2]{};
+    int current[2] = {from, to};
+    bool isBlock[2] = {false, false};
+    bool isDone[2] = {false, false};
+    for (int side = 0; side < 2; ++side) {
+        nodeMarks_m[side].reset(size());
+        blockMarks_m[side].reset(blockParent_m.size());
+    }
+    int meet = -1;
+    int meetSide = -1;
+    bool isMeetBlock = false;
+    for (int side = 0; meet == -1; side = 1-side) {
+        if (isDone[side]) {
+            assert(!isDone[1-side]);
+            continue;
+        }
+        int item = current[side];
+        if (isBlock[side]) {
+            if (blockMarks_m[1-side].isMarked(item)) {
+                meet = item;
+                meetSide = side;
+                isMeetBlock = true;
+                break;
+            }
+            blockMarks_m[side].mark(item);
+            paths[side].push_back(item);
+            current[side] = blockHead_m[item];
+            isBlock[side] = false;
+        }
+        else {
+            if (nodeMarks_m[1-side].isMarked(item)) {
+                meet = item;
+                meetSide = side;
+                break;
+            }
+            nodeMarks_m[side].mark(item);
+            int block = getParentBlock(item);
+            if (block == -1) isDone[side] = true;
+            else {
+                current[side] = block;
+                isBlock[side] = true;
+            }
+        }
+    }
+    // the other side may have climbed past the meeting point
+    std::vector<int> blocks = std::move(paths[meetSide]);
+    const std::vector<int>& otherPath = paths[1-meetSide];
+    int count = 0;
+    if (isMeetBlock) {
+        while (otherPath[count] != meet) ++count;
+        ++count;
+        top = blockHead_m[meet];
+    }
+    else {
+        if (meet != (meetSide == 0 ? to : from)) {
+            while (blockHead_m[otherPath[count]] != meet) ++count;
+            ++count;
+        }
+        top = meet;
+    }
+    blocks.insert(blocks.end(), otherPath.begin(), otherPath.begin()+count);
+    assert(!blocks.empty());
+    return blocks;
+}
+
+// union by number of edges, the merged block hangs from top
+void IncrementalEmbedder::mergeBlocks(const std::vector<int>& blocks, int top, int edge) {
+    int merged = blocks[0];
+    for (int block : blocks)
+        if (blockEdges_m[block].size() > blockEdges_m[merged].size()) merged = block;
+    for (int block : blocks) {
+        if (block == merged) continue;
+        blockParent_m[block] = merged;
+        blockEdges_m[merged].insert(blockEdges_m[merged].end(), blockEdges_m[block].begin(), blockEdges_m[block].end());
+        std::vector<int>().swap(blockEdges_m[block]);
+        --numberOfBlocks_m;
+    }
+    blockHead_m[merged] = top;
+    blockEdges_m[merged].push_back(edge);
+    blockOfEdge_m[edge] = merged;
+}
+
+// the merged block with the new edge is embedded by Embedder; around each of its nodes,
+// its darts are put in the new order followed by the other darts in their old order (what
+// hangs from the node outside of the block goes in one of its corners). the faces through
+// these nodes are then traced again
+bool IncrementalEmbedder::reembed(const std::vector<int>& blocks, int top, int from, int to) {
+    blockMarks_m[0].reset(blockParent_m.size());
+    for (int block : blocks)
+        blockMarks_m[0].mark(block);
+    std::vector<int> nodes{};
+    std::vector<int> edges{};
+    auto addNode = [&](int node) {
+        if (localNode_m[node] != -1) return;
+        localNode_m[node] = nodes.size();
+        nodes.push_back(node);
+    };
+    for (int block : blocks) {
+        for (int edge : blockEdges_m[block]) {
+            addNode(head_m[2*edge+1]);
+            addNode(head_m[2*edge]);
+            edges.push_back(edge);
+        }
+    }
+    GraphBuilder builder(nodes.size());
+    builder.reserve(2*(edges.size()+1));
+    for (int edge : edges)
+        builder.addEdge(localNode_m[head_m[2*edge+1]], localNode_m[head_m[2*edge]]);
+    builder.addEdge(localNode_m[from], localNode_m[to]);
+    const MyGraph block(builder);
+    std::optional<Embedding> embedding = embedder_m.embed(block);
+    if (!embedding.has_value()) {
+        for (int node : nodes)
+            localNode_m[node] = -1;
+        return false;
+    }
+    counters_m.reembeddedEdges += edges.size()+1;
+    int edge = newEdge(from, to);
+    faceMarks_m.reset(faceSize_m.size());
+    int oldFaces = 0;
+    std::vector<int> others{};
+    std::vector<int> order{};
+    for (int i = 0; i < nodes.size(); ++i) {
+        int node = nodes[i];
+        others.clear();
+        order.clear();
+        int first = firstDart_m[node];
+        if (first != -1) {
+            int dart = first;
+            do {
+                for (int face : {face_m[dart], face_m[dart^1]}) {
+                    if (faceMarks_m.isMarked(face)) continue;
+                    faceMarks_m.mark(face);
+                    ++oldFaces;
+                }
+                if (blockMarks_m[0].isMarked(findBlock(blockOfEdge_m[dart/2]))) dartTo_m[head_m[dart]] = dart;
+                else others.push_back(dart);
+                dart = nextAround_m[dart];
+            } while (dart != first);
+        }
+        if (node == from) dartTo_m[to] = 2*edge;
+        if (node == to) dartTo_m[from] = 2*edge+1;
+        for (int neighbor : embedding.value().getNeighborsOfNode(i)) {
+            order.push_back(dartTo_m[nodes[neighbor]]);
+            dartTo_m[nodes[neighbor]] = -1;
+        }
+        order.insert(order.end(), others.begin(), others.end());
+        for (int j = 0; j < order.size(); ++j) {
+            int next = order[j+1 < order.size() ? j+1 : 0];
+            nextAround_m[order[j]] = next;
+            prevAround_m[next] = order[j];
+        }
+        firstDart_m[node] = order[0];
+    }
+    numberOfFaces_m -= oldFaces;
+    dartMarks_m.reset(head_m.size());
+    for (int node : nodes) {
+        int dart = firstDart_m[node];
+        do {
+            for (int start : {dart, dart^1}) {
+                if (dartMarks_m.isMarked(start)) continue;
+                int face = newFace(0);
+                int current = start;
+                do {
+                    dartMarks_m.mark(current);
+                    face_m[current] = face;
+                    ++faceSize_m[face];
+                    current = nextInFace(current);
+                } while (current != start);
+            }
+            dart = nextAround_m[dart];
+        } while (dart != firstDart_m[node]);
+    }
+    for (int node : nodes)
+        localNode_m[node] = -1;
+    mergeBlocks(blocks, top, edge);
+    return true;
+}
+
+int IncrementalEmbedder::size() const {
+    return firstDart_m.size();
+}
+
+int IncrementalEmbedder::numberOfEdges() const {
+    return head_m.size()/2;
+}
+
+int IncrementalEmbedder::numberOfFaces() const {
+    return numberOfFaces_m;
+}
+
+int IncrementalEmbedder::numberOfBlocks() const {
+    return numberOfBlocks_m;
+}
+
+// walks both rotations together, so in time linear in the smaller degree
+bool IncrementalEmbedder::hasEdge(int from, int to) const {
+    int fromFirst = firstDart_m[from];
+    int toFirst = firstDart_m[to];
+    if (fromFirst == -1 || toFirst == -1) return false;
+    int fromDart = fromFirst;
+    int toDart = toFirst;
+    do {
+        if (head_m[fromDart] == to || head_m[toDart] == from) return true;
+        fromDart = nextAround_m[fromDart];
+        toDart = nextAround_m[toDart];
+    } while (fromDart != fromFirst && toDart != toFirst);
+    return false;
+}
+
+bool IncrementalEmbedder::addEdge(int from, int to) {
+    assert(from >= 0 && from < size() && to >= 0 && to < size());
+    if (from == to || hasEdge(from, to)) return true;
+    if (findComponent(from) != findComponent(to)) {
+        joinComponents(from, to);
+        ++counters_m.joinedComponents;
+        return true;
+    }
+    int top = -1;
+    std::vector<int> blocks = findBlocksBetween(from, to, top);
+    int fromDart = -1;
+    int toDart = -1;
+    if (findCommonFace(from, to, fromDart, toDart)) {
+        int edge = newEdge(from, to);
+        insertDartBefore(2*edge, from, fromDart);
+        insertDartBefore(2*edge+1, to, toDart);
+        splitFace(edge);
+        mergeBlocks(blocks, top, edge);
+        ++counters_m.onCommonFace;
+        return true;
+    }
+    if (!reembed(blocks, top, from, to)) {
+        ++counters_m.rejected;
+        return false;
+    }
+    ++counters_m.reembedded;
+    return true;
+}
+
+Embedding IncrementalEmbedder::getEmbedding() const {
+    GraphBuilder builder(size());
+    builder.reserve(head_m.size());
+    for (int node = 0; node < size(); ++node) {
+        int first = firstDart_m[node];
+        if (first == -1) continue;
+        int dart = first;
+        do {
+            builder.addSingleEdge(node, head_m[dart]);
+            dart = nextAround_m[dart];
+        } while (dart != first);
+    }
+    return Embedding(builder);
+}
+
+const IncrementalCounters& IncrementalEmbedder::getCounters() const {
+    return counters_m;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef MY_INCREMENTAL_EMBEDDER_H
+#define MY_INCREMENTAL_EMBEDDER_H
+
+#include <vector>
+
+#include "graph.hpp"
+#include "workspace.hpp"
+#include "embedder.hpp"
+
+// how the edges given to an IncrementalEmbedder were handled
+struct IncrementalCounters {
+    long long joinedComponents{0};
+    long long onCommonFace{0};
+    long long reembedded{0};
+    long long rejected{0};
+    // edges of all the blocks embedded again
+    long long reembeddedEdges{0};
+};
+
+// planar graph built one edge at a time, with an embedding kept up to date: an edge is added
+// only if the graph stays planar. the embedding is a rotation system of darts (edge e is
+// darts 2e and 2e+1) with a face id on every dart. the blocks (biconnected components) form
+// a rooted forest, each block hanging from its head node and each other node of a block
+// hanging from it (block-cut tree), blocks being merged with union-find.
+// an edge between two connected components joins two faces, an edge between two nodes of a
+// common face splits it (the smaller part gets a new id, so both are block local and
+// amortized O(log) per dart relabeled), any other edge merges the blocks on the path between
+// its ends and only that block is embedded again, with Embedder
+class IncrementalEmbedder {
+private:
+    // head of each dart, the tail being the head of its twin (dart^1)
+    std::vector<int> head_m{};
+    // rotation around the tail of each dart, both ways
+    std::vector<int> nextAround_m{};
+    std::vector<int> prevAround_m{};
+    std::vector<int> face_m{};
+    std::vector<int> faceSize_m{};
+    int numberOfFaces_m{0};
+    // -1 for nodes without edges
+    std::vector<int> firstDart_m{};
+    // connected components (union-find)
+    std::vector<int> componentParent_m{};
+    std::vector<int> componentSize_m{};
+    // blocks (union-find): only the representative of a block has its head and edges
+    std::vector<int> blockParent_m{};
+    std::vector<int> blockHead_m{};
+    std::vector<std::vector<int>> blockEdges_m{};
+    std::vector<int> blockOfEdge_m{};
+    // block each node hangs from, -1 for the root of a tree of blocks
+    std::vector<int> parentBlock_m{};
+    int numberOfBlocks_m{0};
+    Embedder embedder_m{};
+    IncrementalCounters counters_m{};
+    // scratch
+    EpochMarker nodeMarks_m[2]{};
+    EpochMarker blockMarks_m[2]{};
+    EpochMarker faceMarks_m{};
+    EpochMarker dartMarks_m{};
+    std::vector<int> localNode_m{};
+    std::vector<int> dartTo_m{};
+
+    int findComponent(int node);
+    int findBlock(int block);
+    int getParentBlock(int node);
+    int newEdge(int from, int to);
+    void insertDartBefore(int dart, int tail, int before);
+    int nextInFace(int dart) const;
+    int newFace(int size);
+    void labelFace(int start, int face);
+    void joinComponents(int from, int to);
+    void evert(int node);
+    bool findCommonFace(int from, int to, int& fromDart, int& toDart);
+    void splitFace(int edge);
+    std::vector<int> findBlocksBetween(int from, int to, int& top);
+    void mergeBlocks(const std::vector<int>& blocks, int top, int edge);
+    bool reembed(const std::vector<int>& blocks, int top, int from, int to);
+
+public:
+    // numberOfNodes nodes without edges
+    IncrementalEmbedder(int numberOfNodes);
+    // starts from an embedding (blocks found by BiconnectedComponentsHandler)
+    IncrementalEmbedder(const Embedding& embedding);
+
+    int size() const;
+    int numberOfEdges() const;
+    int numberOfFaces() const;
+    int numberOfBlocks() const;
+    bool hasEdge(int from, int to) const;
+    // adds the edge if the graph stays planar, otherwise returns false and nothing changes
+    // (edges already there and self loops change nothing and return true)
+    bool addEdge(int from, int to);
+    Embedding getEmbedding() const;
+    const IncrementalCounters& getCounters() const;
+};
+
+#endif
\ No newline at end of file
@@ -1,65 +1,156 @@
 #include "interlacement.hpp"
 
 #include <cassert>
+#include <algorithm>
+#include <limits>
+#include <tuple>
 
 #include "utils.hpp"
 
-InterlacementGraph::InterlacementGraph(const Cycle& cycle, const std::vector<Segment>& segments) 
-    : MyGraph(segments.size()), cycle_m(cycle) , segments_m(segments) {
-    computeConflicts();
-}
+InterlacementGraph::InterlacementGraph(const Cycle& cycle, const std::vector<Segment>& segments,
+EmbedderWorkspace& workspace)
+    : MyGraph(computeConflicts(cycle, segments, workspace)), cycle_m(cycle) , segments_m(segments) {}
 
-void InterlacementGraph::computeCycleLabels(const Segment& segment, int cycleLabels[]) {
-    int originalComponentSize = cycle_m.getOriginalComponentSize();
-    bool isCycleNodeAnAttachment[originalComponentSize];
-    for (int i = 0; i < originalComponentSize; ++i)
-        isCycleNodeAnAttachment[i] = false;
-    for (const int attachment : segment.getAttachments())
-        isCycleNodeAnAttachment[segment.getLabelOfNode(attachment)] = true;
-    int foundAttachments = 0;
-    int totalAttachments = segment.getAttachments().size();
-    for (int i = 0; i < cycle_m.size(); ++i) {
-        int node = cycle_m.nodes()[i];
-        if (isCycleNodeAnAttachment[node])
-            cycleLabels[node] = 2*(foundAttachments++);
-        else
-            if (foundAttachments == 0)
-                cycleLabels[node] = 2*totalAttachments-1;
-            else
-                cycleLabels[node] = 2*foundAttachments-1;
-    }
-    assert(foundAttachments == totalAttachments);
-}
+namespace {
+    // static 2D points (x, y, id), sorted by x, answering "all the points in a rectangle"
+    // queries in O(log^2 n + reported points): level L keeps blocks of 2^L consecutive
+    // points (in x order) sorted by y
+    class MergeSortTree {
+    private:
+        std::vector<int> xs_m{};
+        std::vector<std::vector<std::pair<int, int>>> levels_m{}; // (y, id)
 
-void InterlacementGraph::computeConflicts() {
-    int cycleLabels[cycle_m.getOriginalComponentSize()];
-    for (int i = 0; i < segments_m.size()-1; ++i) {
-        const Segment& segment = segments_m[i];
-        computeCycleLabels(segment, cycleLabels);
-        int numberOfLabels = 2*segment.getAttachments().size();
-        int labels[numberOfLabels];
-        for (int j = i+1; j < segments_m.size(); ++j) {
-            const Segment& otherSegment = segments_m[j];
-            for (int k = 0; k < numberOfLabels; ++k)
-                labels[k] = 0;
-            for (const int attachment : otherSegment.getAttachments()) {
-                int attachmentLabel = otherSegment.getLabelOfNode(attachment);
-                labels[cycleLabels[attachmentLabel]] = 1;
+    public:
+        MergeSortTree(std::vector<std::tuple<int, int, int>>& points) {
+            std::sort(points.begin(), points.end());
+            int size = 1;
+            while (size < points.size()) size *= 2;
+            levels_m.emplace_back(size, std::make_pair(std::numeric_limits<int>::max(), -1));
+            for (int i = 0; i < points.size(); ++i) {
+                xs_m.push_back(std::get<0>(points[i]));
+                levels_m[0][i] = std::make_pair(std::get<1>(points[i]), std::get<2>(points[i]));
             }
-            int sum = 0;
-            for (int k = 0; k < numberOfLabels; ++k)
-                sum += labels[k];
-            int partSum = labels[0] + labels[1] + labels[2];
-            bool areInConflict = true;
-            for (int k = 0; k <= numberOfLabels-2; k += 2) {
-                if (partSum == sum) {
-                    areInConflict = false;
-                    break;
-                }
-                partSum = partSum + labels[(3+k) % numberOfLabels] + labels[(4+k) % numberOfLabels];
-                partSum = partSum - labels[k] - labels[(1+k) % numberOfLabels];
+            for (int block = 2; block <= size; block *= 2) {
+                const std::vector<std::pair<int, int>>& lower = levels_m.back();
+                std::vector<std::pair<int, int>> level(size);
+                for (int i = 0; i < size; i += block)
+                    std::merge(lower.begin()+i, lower.begin()+i+block/2, lower.begin()+i+block/2,
+                        lower.begin()+i+block, level.begin()+i);
+                levels_m.push_back(std::move(level));
             }
-            if (areInConflict) addEdge(i, j);
         }
-    }   
+
+        // calls report(id) for each point with xLow <= x <= xHigh and yLow <= y <= yHigh,
+        // until report returns false (then query returns false too)
+        template <typename Callback>
+        bool query(int xLow, int xHigh, int yLow, int yHigh, Callback report) const {
+            if (xLow > xHigh || yLow > yHigh) return true;
+            int from = std::lower_bound(xs_m.begin(), xs_m.end(), xLow)-xs_m.begin();
+            int to = std::upper_bound(xs_m.begin(), xs_m.end(), xHigh)-xs_m.begin();
+            int level = 0;
+            while (from < to) {
+                if ((from & 1) && !reportBlock(level, from++, yLow, yHigh, report)) return false;
+                if ((to & 1) && !reportBlock(level, --to, yLow, yHigh, report)) return false;
+                from /= 2;
+                to /= 2;
+                ++level;
+            }
+            return true;
+        }
+
+    private:
+        template <typename Callback>
+        bool reportBlock(int level, int block, int yLow, int yHigh, Callback& report) const {
+            auto begin = levels_m[level].begin()+(block << level);
+            auto end = begin+(1 << level);
+            auto it = std::lower_bound(begin, end, std::make_pair(yLow, std::numeric_limits<int>::min()));
+            for (; it != end && it->first <= yHigh; ++it)
+                if (!report(it->second)) return false;
+            return true;
+        }
+    };
+
+    // with positions along the cycle, segments S and T are in conflict if and only if
+    // S has an attachment strictly between the extreme attachments of T and vice versa;
+    // calling [min, max] the span of a segment this means:
+    // - spans that cross (minS < minT < maxS < maxT) are always in conflict
+    // - if the span of T is inside the span of S, they are in conflict if the span of T
+    //   is not inside a single gap between consecutive attachments of S
+    //   (and T is not only attached to the two ends of S)
+    // each segment is the point (min, max), both cases are rectangle queries.
+    // calls report(i, j) for each conflict (a pair may come twice) until it returns false
+    template <typename Callback>
+    bool forEachConflict(const Cycle& cycle, const std::vector<Segment>& segments, Callback report) {
+        std::vector<std::tuple<int, int, int>> points{};
+        points.reserve(segments.size());
+        for (int i = 0; i < segments.size(); ++i)
+            points.push_back(std::make_tuple(segments[i].getAttachments().front(), segments[i].getAttachments().back(), i));
+        const MergeSortTree tree(points);
+        for (int i = 0; i < segments.size(); ++i) {
+            const std::vector<int>& attachments = segments[i].getAttachments();
+            int min = attachments.front();
+            int max = attachments.back();
+            // crossing spans
+            bool isDone = !tree.query(min+1, max-1, max+1, cycle.size()-1, [&](int j) {
+                return report(i, j);
+            });
+            if (isDone) return false;
+            // span of j inside the span of i: the min of j is in the gap [attachments[k], attachments[k+1]),
+            // its max must be after attachments[k+1]
+            for (int k = 0; k < attachments.size()-1; ++k) {
+                isDone = !tree.query(attachments[k], attachments[k+1]-1, attachments[k+1]+1, max, [&](int j) {
+                    if (j == i) return true;
+                    const std::vector<int>& otherAttachments = segments[j].getAttachments();
+                    if (otherAttachments.size() == 2 && otherAttachments.front() == min && otherAttachments.back() == max)
+                        return true;
+                    return report(i, j);
+                });
+                if (isDone) return false;
+            }
+        }
+        return true;
+    }
+}
+
+const GraphBuilder InterlacementGraph::computeConflicts(const Cycle& cycle, const std::vector<Segment>& segments,
+EmbedderWorkspace& workspace) {
+    GraphBuilder builder(segments.size());
+    std::vector<std::pair<int, int>>& conflicts = workspace.conflicts;
+    conflicts.clear();
+    forEachConflict(cycle, segments, [&](int i, int j) {
+        conflicts.push_back(std::minmax(i, j));
+        return true;
+    });
+    // same edges, in the same order, of comparing every pair (i, j) with i < j
+    std::sort(conflicts.begin(), conflicts.end());
+    conflicts.erase(std::unique(conflicts.begin(), conflicts.end()), conflicts.end());
+    builder.reserve(2*conflicts.size());
+    for (const std::pair<int, int>& conflict : conflicts)
+        builder.addEdge(conflict.first, conflict.second);
+    return builder;
+}
+
+// colors are flipped so that the smallest segment of each set gets 0, which is the coloring
+// of MyGraph::computeBipartition on the interlacement graph
+std::optional<std::vector<int>> computeInterlacementBipartition(const Cycle& cycle, const std::vector<Segment>& segments,
+EmbedderWorkspace& workspace, long long& numberOfConflicts) {
+    ParityUnionFind& parity = workspace.conflictParity;
+    parity.reset(segments.size());
+    numberOfConflicts = 0;
+    bool isBipartite = forEachConflict(cycle, segments, [&](int i, int j) {
+        ++numberOfConflicts;
+        return parity.join(i, j);
+    });
+    if (!isBipartite) return std::nullopt;
+    std::vector<int> bipartition(segments.size());
+    // flip of each root, -1 until the smallest segment of its set is met
+    std::vector<int>& flip = workspace.nodeMap;
+    workspace.reserveNodes(segments.size());
+    std::fill(flip.begin(), flip.begin()+segments.size(), -1);
+    for (int i = 0; i < segments.size(); ++i) {
+        int root = parity.find(i);
+        if (flip[root] == -1) flip[root] = parity.parityOf(i);
+        bipartition[i] = parity.parityOf(i) ^ flip[root];
+    }
+    return bipartition;
 }
\ No newline at end of file
@@ -2,20 +2,31 @@
 #define MY_INTERLACEMENT_H
 
 #include <vector>
+#include <optional>
 
 #include "graph.hpp"
 #include "segment.hpp"
 #include "cycle.hpp"
+#include "workspace.hpp"
 
+// conflict graph of the segments of a cycle: two segments are adjacent if they cannot be
+// on the same side of the cycle (kept as a graph only to find witnesses, see kuratowski.hpp)
 class InterlacementGraph : public MyGraph {
 private:
     const Cycle& cycle_m;
     const std::vector<Segment>& segments_m;
     
-    void computeConflicts();
-    void computeCycleLabels(const Segment& segment, int cycleLabels[]);
+    static const GraphBuilder computeConflicts(const Cycle& cycle, const std::vector<Segment>& segments,
+        EmbedderWorkspace& workspace);
 public:
-    InterlacementGraph(const Cycle& cycle, const std::vector<Segment>& segments);
+    InterlacementGraph(const Cycle& cycle, const std::vector<Segment>& segments, EmbedderWorkspace& workspace);
 };
 
+// side of each segment (0 inside, 1 outside) as computeBipartition of the InterlacementGraph, but
+// without building it: the conflicts go to a ParityUnionFind as they are found and the first
+// one closing an odd cycle stops the search (nullopt, the segments cannot be placed).
+// numberOfConflicts counts the conflicts seen until then
+std::optional<std::vector<int>> computeInterlacementBipartition(const Cycle& cycle, const std::vector<Segment>& segments,
+    EmbedderWorkspace& workspace, long long& numberOfConflicts);
+
 #endif
\ No newline at end of file
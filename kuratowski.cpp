@@ -0,0 +1,361 @@
+#include "kuratowski.hpp"
+
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
+
+#include "embedder.hpp"
+
+namespace {
+    using Edges = std::vector<std::pair<int, int>>;
+
+    // odd cycle of a non bipartite graph from its bfs forest: an edge between two nodes
+    // with the same color closes it with the tree paths to their common ancestor
+    std::vector<int> findOddCycle(const MyGraph& graph) {
+        std::vector<int> color(graph.size(), -1);
+        std::vector<int> parent(graph.size(), -1);
+        std::vector<int> depth(graph.size(), 0);
+        std::vector<int> queue{};
+        for (int root = 0; root < graph.size(); ++root) {
+            if (color[root] != -1) continue;
+            color[root] = 0;
+            queue.assign(1, root);
+            for (int head = 0; head < queue.size(); ++head) {
+                int node = queue[head];
+                for (int neighbor : graph.getNeighborsOfNode(node)) {
+                    if (color[neighbor] == -1) {
+                        color[neighbor] = 1-color[node];
+                        parent[neighbor] = node;
+                        depth[neighbor] = depth[node]+1;
+                        queue.push_back(neighbor);
+                        continue;
+                    }
+                    if (color[neighbor] != color[node]) continue;
+                    std::vector<int> cycle{node};
+                    std::vector<int> otherSide{neighbor};
+                    int first = node;
+                    int second = neighbor;
+                    while (depth[first] > depth[second]) cycle.push_back(first = parent[first]);
+                    while (depth[second] > depth[first]) otherSide.push_back(second = parent[second]);
+                    while (first != second) {
+                        cycle.push_back(first = parent[first]);
+                        otherSide.push_back(second = parent[second]);
+                    }
+                    otherSide.pop_back(); // the common ancestor
+                    cycle.insert(cycle.end(), otherSide.rbegin(), otherSide.rend());
+                    return cycle;
+                }
+            }
+        }
+        return {};
+    }
+
+    // attachments (cycle positions) that keep two conflicting segments in conflict: two of
+    // each alternating along the cycle, or three in common; segments do not conflict exactly
+    // when all the attachments of the first lie between two consecutive ones of the second
+    void findConflictAttachments(const std::vector<int>& first, const std::vector<int>& second,
+    std::vector<int>& keepFirst, std::vector<int>& keepSecond) {
+        int q = second.size();
+        // gap g goes from second[g] to second[g+1] (the last one through the end of the cycle),
+        // -1 for attachments of second
+        auto gapOf = [&](int position) {
+            auto it = std::lower_bound(second.begin(), second.end(), position);
+            if (it != second.end() && *it == position) return -1;
+            return int(it-second.begin()+q-1) % q;
+        };
+        auto isInClosedGap = [&](int position, int gap) {
+            return position == second[gap] || position == second[(gap+1) % q] || gapOf(position) == gap;
+        };
+        for (int x : first) {
+            int gap = gapOf(x);
+            if (gap == -1) continue;
+            for (int y : first) {
+                if (isInClosedGap(y, gap)) continue;
+                keepFirst.insert(keepFirst.end(), {x, y});
+                keepSecond.insert(keepSecond.end(), {second[gap], second[(gap+1) % q]});
+                return;
+            }
+            assert(false);
+        }
+        // all the attachments of first are attachments of second
+        if (first.size() >= 3) {
+            keepFirst.insert(keepFirst.end(), first.begin(), first.begin()+3);
+            keepSecond.insert(keepSecond.end(), first.begin(), first.begin()+3);
+            return;
+        }
+        // two attachments of second that are not consecutive: one of second on each arc between them
+        int i = std::lower_bound(second.begin(), second.end(), first[0])-second.begin();
+        int j = std::lower_bound(second.begin(), second.end(), first[1])-second.begin();
+        assert(j > i+1 && !(i == 0 && j == q-1));
+        keepFirst.insert(keepFirst.end(), {first[0], first[1]});
+        keepSecond.insert(keepSecond.end(), {second[i+1], second[j+1 < q ? j+1 : 0]});
+    }
+
+    // tree of the segment joining the given attachments through its own nodes, as edges of the
+    // component: the first attachment is the root, with a single edge (going through an
+    // attachment would split the segment in two)
+    void addSteinerTree(const Segment& segment, const std::vector<int>& terminals, Edges& edges) {
+        if (segment.isChord()) {
+            edges.push_back(std::make_pair(segment.getLabelOfNode(0), segment.getLabelOfNode(1)));
+            return;
+        }
+        int root = terminals[0];
+        std::vector<int> parent(segment.size(), -2); // -2 for nodes not reached
+        parent[root] = -1;
+        std::vector<int> queue{};
+        for (int neighbor : segment.getNeighborsOfNode(root)) {
+            if (segment.isNodeAnAttachment(neighbor) || segment.isNodeADummy(neighbor)) continue;
+            parent[neighbor] = root;
+            queue.push_back(neighbor);
+            break;
+        }
+        for (int head = 0; head < queue.size(); ++head) {
+            int node = queue[head];
+            if (segment.isNodeAnAttachment(node)) continue;
+            for (int neighbor : segment.getNeighborsOfNode(node)) {
+                if (parent[neighbor] != -2) continue;
+                parent[neighbor] = node;
+                queue.push_back(neighbor);
+            }
+        }
+        std::vector<bool> isInTree(segment.size(), false);
+        isInTree[root] = true;
+        for (int terminal : terminals) {
+            for (int node = terminal; !isInTree[node]; node = parent[node]) {
+                assert(parent[node] >= 0);
+                isInTree[node] = true;
+                edges.push_back(std::make_pair(segment.getLabelOfNode(node), segment.getLabelOfNode(parent[node])));
+            }
+        }
+    }
+
+    // the subgraph is a cycle with trees hanging between its nodes: its paths of nodes of degree 2
+    // are contracted, then paths are dropped as long as the rest stays non planar; each round finds
+    // by binary search the shortest prefix of the remaining paths that, with the required ones,
+    // is non planar: its last path is required and the paths after it are not needed.
+    // what is left is an edge minimal non planar graph, so a subdivision of K5 or K3,3
+    Edges minimizeNonPlanarSubgraph(int numberOfNodes, const Edges& edges) {
+        GraphBuilder builder(numberOfNodes);
+        builder.reserve(2*edges.size());
+        for (const auto& [from, to] : edges)
+            builder.addEdge(from, to);
+        const MyGraph subgraph(builder);
+        auto isBranch = [&](int node) { return subgraph.getNeighborsOfNode(node).size() > 2; };
+        std::vector<int> pathNodes{};
+        std::vector<int> pathOffsets{0};
+        std::vector<bool> isInner(numberOfNodes, false);
+        for (int node = 0; node < numberOfNodes; ++node) {
+            if (!isBranch(node)) continue;
+            for (int neighbor : subgraph.getNeighborsOfNode(node)) {
+                if (isBranch(neighbor) ? node > neighbor : isInner[neighbor]) continue;
+                pathNodes.push_back(node);
+                int prev = node;
+                int current = neighbor;
+                while (!isBranch(current)) {
+                    isInner[current] = true;
+                    pathNodes.push_back(current);
+                    std::span<const int> neighbors = subgraph.getNeighborsOfNode(current);
+                    int next = neighbors[0] == prev ? neighbors[1] : neighbors[0];
+                    prev = current;
+                    current = next;
+                }
+                assert(current != node);
+                pathNodes.push_back(current);
+                pathOffsets.push_back(pathNodes.size());
+            }
+        }
+        // test graphs: the branch nodes, then one node for each path with inner nodes (so they stay simple)
+        std::vector<int> compactNode(numberOfNodes, -1);
+        int numberOfBranchNodes = 0;
+        for (int node = 0; node < numberOfNodes; ++node)
+            if (isBranch(node)) compactNode[node] = numberOfBranchNodes++;
+        int numberOfPaths = pathOffsets.size()-1;
+        Embedder oracle{};
+        std::vector<int> required{};
+        std::vector<int> remaining(numberOfPaths);
+        for (int path = 0; path < numberOfPaths; ++path)
+            remaining[path] = path;
+        auto isNonPlanar = [&](int prefix) {
+            GraphBuilder test(numberOfBranchNodes+numberOfPaths);
+            auto addPath = [&](int path) {
+                int from = compactNode[pathNodes[pathOffsets[path]]];
+                int to = compactNode[pathNodes[pathOffsets[path+1]-1]];
+                if (pathOffsets[path+1]-pathOffsets[path] == 2) {
+                    test.addEdge(from, to);
+                    return;
+                }
+                test.addEdge(from, numberOfBranchNodes+path);
+                test.addEdge(numberOfBranchNodes+path, to);
+            };
+            for (int path : required) addPath(path);
+            for (int i = 0; i < prefix; ++i) addPath(remaining[i]);
+            return !oracle.embed(MyGraph(test)).has_value();
+        };
+        assert(isNonPlanar(numberOfPaths));
+        while (!isNonPlanar(0)) {
+            int low = 1;
+            int high = remaining.size();
+            while (low < high) {
+                int middle = (low+high)/2;
+                if (isNonPlanar(middle)) high = middle;
+                else low = middle+1;
+            }
+            required.push_back(remaining[low-1]);
+            remaining.resize(low-1);
+        }
+        Edges subdivision{};
+        for (int path : required)
+            for (int i = pathOffsets[path]; i+1 < pathOffsets[path+1]; ++i)
+                subdivision.push_back(std::make_pair(pathNodes[i], pathNodes[i+1]));
+        return subdivision;
+    }
+}
+
+// the cycle with the segments of an odd cycle of the interlacement graph is not planar, and stays
+// so if each of these segments is cut down to a tree joining the attachments that keep it in
+// conflict with its two neighbors on the odd cycle (at most 6): this subgraph is then minimized
+std::vector<std::pair<int, int>> findKuratowskiSubdivision(const Component& component, const Cycle& cycle,
+const std::vector<Segment>& segments, const MyGraph& interlacementGraph) {
+    std::vector<int> oddCycle = findOddCycle(interlacementGraph);
+    assert(oddCycle.size() >= 3 && oddCycle.size() % 2 == 1);
+    std::vector<std::vector<int>> keptAttachments(oddCycle.size());
+    for (int i = 0; i < oddCycle.size(); ++i) {
+        int next = (i+1) % oddCycle.size();
+        findConflictAttachments(segments[oddCycle[i]].getAttachments(), segments[oddCycle[next]].getAttachments(),
+            keptAttachments[i], keptAttachments[next]);
+    }
+    Edges edges{};
+    for (int i = 0; i < cycle.size(); ++i)
+        edges.push_back(std::make_pair(cycle.nodes()[i], cycle.nodes()[(i+1) % cycle.size()]));
+    for (int i = 0; i < oddCycle.size(); ++i) {
+        const Segment& segment = segments[oddCycle[i]];
+        std::vector<int>& terminals = keptAttachments[i];
+        std::sort(terminals.begin(), terminals.end());
+        terminals.erase(std::unique(terminals.begin(), terminals.end()), terminals.end());
+        for (int& terminal : terminals)
+            terminal = segment.getAttachmentOfCycleNode(terminal);
+        addSteinerTree(segment, terminals, edges);
+    }
+    return minimizeNonPlanarSubgraph(component.size(), edges);
+}
+
+// with two attachments each arc of the contracted cycle keeps a dummy node (the first one
+// on the arc from attachment 0 to attachment 1), in a subdivision it has both of its edges
+void liftToOriginalComponent(const Segment& segment, std::vector<std::pair<int, int>>& edges) {
+    const Cycle& cycle = segment.getOriginalCycle();
+    const std::vector<int>& attachments = segment.getAttachments();
+    Edges lifted{};
+    // arc of the cycle going forward from position from to position to
+    auto addArc = [&](int from, int to) {
+        for (int position = from; position != to; position = (position+1) % cycle.size())
+            lifted.push_back(std::make_pair(cycle.nodes()[position], cycle.nodes()[(position+1) % cycle.size()]));
+    };
+    for (const auto& [from, to] : edges) {
+        if (segment.isNodeADummy(from) || segment.isNodeADummy(to)) {
+            int dummy = segment.isNodeADummy(from) ? from : to;
+            if (std::min(from, to) != 0) continue; // added from the other edge of the dummy
+            if (dummy == segment.size()-2) addArc(attachments[0], attachments[1]);
+            else addArc(attachments[1], attachments[0]);
+            continue;
+        }
+        if (attachments.size() > 2 && segment.isNodeAnAttachment(from) && segment.isNodeAnAttachment(to)) {
+            int low = std::min(from, to);
+            int high = std::max(from, to);
+            if (high == low+1) addArc(attachments[low], attachments[high]);
+            else addArc(attachments[high], attachments[low]); // from the last attachment to the first
+            continue;
+        }
+        lifted.push_back(std::make_pair(segment.getLabelOfNode(from), segment.getLabelOfNode(to)));
+    }
+    edges = std::move(lifted);
+}
+
+void liftToOriginalGraph(const Component& component, std::vector<std::pair<int, int>>& edges) {
+    for (auto& [from, to] : edges) {
+        from = component.getLabelOfNode(from);
+        to = component.getLabelOfNode(to);
+    }
+}
+
+// nodes of degree > 2 are the branch nodes, the paths between them must be the edges of K5 or K3,3
+const char* checkKuratowskiSubdivision(const MyGraph& graph, const std::vector<std::pair<int, int>>& edges) {
+    auto edgeKey = [](int from, int to) {
+        return uint64_t(uint32_t(std::min(from, to))) << 32 | uint32_t(std::max(from, to));
+    };
+    std::vector<uint64_t> graphEdges{};
+    graphEdges.reserve(graph.numberOfEdges());
+    for (int node = 0; node < graph.size(); ++node)
+        for (int neighbor : graph.getNeighborsOfNode(node))
+            if (node < neighbor) graphEdges.push_back(edgeKey(node, neighbor));
+    std::sort(graphEdges.begin(), graphEdges.end());
+    std::vector<uint64_t> witnessEdges{};
+    GraphBuilder builder(graph.size());
+    builder.reserve(2*edges.size());
+    for (const auto& [from, to] : edges) {
+        if (from < 0 || to < 0 || from >= graph.size() || to >= graph.size()) return "node out of range";
+        if (!std::binary_search(graphEdges.begin(), graphEdges.end(), edgeKey(from, to)))
+            return "edge not in the graph";
+        witnessEdges.push_back(edgeKey(from, to));
+        builder.addEdge(from, to);
+    }
+    std::sort(witnessEdges.begin(), witnessEdges.end());
+    if (std::adjacent_find(witnessEdges.begin(), witnessEdges.end()) != witnessEdges.end()) return "repeated edge";
+    const MyGraph witness(builder);
+    std::vector<int> branchNodes{};
+    for (int node = 0; node < witness.size(); ++node) {
+        int degree = witness.getNeighborsOfNode(node).size();
+        if (degree == 1) return "node of degree 1";
+        if (degree > 2) branchNodes.push_back(node);
+    }
+    bool isK5 = branchNodes.size() == 5;
+    if (!isK5 && branchNodes.size() != 6) return "wrong number of branch nodes";
+    for (int node : branchNodes)
+        if (witness.getNeighborsOfNode(node).size() != (isK5 ? 4 : 3)) return "wrong degree of a branch node";
+    // paths between branch nodes, each walked from both of its ends
+    std::vector<int> branchIndex(graph.size(), -1);
+    for (int i = 0; i < branchNodes.size(); ++i)
+        branchIndex[branchNodes[i]] = i;
+    std::vector<std::vector<bool>> isJoined(branchNodes.size(), std::vector<bool>(branchNodes.size(), false));
+    long long walkedEdges = 0;
+    for (int i = 0; i < branchNodes.size(); ++i) {
+        for (int neighbor : witness.getNeighborsOfNode(branchNodes[i])) {
+            int prev = branchNodes[i];
+            int current = neighbor;
+            ++walkedEdges;
+            while (branchIndex[current] == -1) {
+                std::span<const int> neighbors = witness.getNeighborsOfNode(current);
+                int next = neighbors[0] == prev ? neighbors[1] : neighbors[0];
+                prev = current;
+                current = next;
+                ++walkedEdges;
+            }
+            int j = branchIndex[current];
+            if (j == i) return "path from a branch node back to itself";
+            if (isJoined[i][j]) return "two paths between the same branch nodes";
+            isJoined[i][j] = true;
+        }
+    }
+    if (walkedEdges != 2*edges.size()) return "cycle not through the branch nodes";
+    if (isK5) return nullptr;
+    // 3-regular on 6 nodes with no triangle: the sides of K3,3 are the neighbors of a node and the rest
+    std::vector<int> side(branchNodes.size(), 0);
+    for (int j = 0; j < branchNodes.size(); ++j)
+        if (isJoined[0][j]) side[j] = 1;
+    for (int i = 0; i < branchNodes.size(); ++i)
+        for (int j = 0; j < branchNodes.size(); ++j)
+            if (isJoined[i][j] && side[i] == side[j]) return "branch nodes do not form K3,3";
+    return nullptr;
+}
+
+const char* kuratowskiGraphName(const std::vector<std::pair<int, int>>& edges) {
+    std::vector<int> nodes{};
+    for (const auto& [from, to] : edges) {
+        nodes.push_back(from);
+        nodes.push_back(to);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    // each node appears once per incident edge: branch nodes of K5 have degree 4
+    for (int i = 0; i+3 < nodes.size(); ++i)
+        if (nodes[i] == nodes[i+3]) return "K5";
+    return "K3,3";
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef MY_KURATOWSKI_H
+#define MY_KURATOWSKI_H
+
+#include <vector>
+#include <utility>
+
+#include "graph.hpp"
+#include "biconnectedComponent.hpp"
+#include "cycle.hpp"
+#include "segment.hpp"
+
+// subdivisions of K5 or K3,3, as lists of edges, proving that a graph is not planar
+
+// a subdivision inside component (edges between its nodes) when the interlacement graph
+// of the segments of cycle is not bipartite
+std::vector<std::pair<int, int>> findKuratowskiSubdivision(const Component& component, const Cycle& cycle,
+    const std::vector<Segment>& segments, const MyGraph& interlacementGraph);
+// from the nodes of segment to the nodes of the component the segment comes from:
+// edges of the contracted cycle become the arcs of the cycle they stand for
+void liftToOriginalComponent(const Segment& segment, std::vector<std::pair<int, int>>& edges);
+// from the nodes of component to the nodes of the graph it is a component of
+void liftToOriginalGraph(const Component& component, std::vector<std::pair<int, int>>& edges);
+
+// nullptr if edges are a subdivision of K5 or K3,3 made of edges of graph, otherwise what is wrong
+const char* checkKuratowskiSubdivision(const MyGraph& graph, const std::vector<std::pair<int, int>>& edges);
+// "K5" or "K3,3", for a subdivision that passed the check
+const char* kuratowskiGraphName(const std::vector<std::pair<int, int>>& edges);
+
+#endif
\ No newline at end of file
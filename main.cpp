@@ -1,28 +1,199 @@
 #include <iostream>
 #include <optional>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
 
 #include "graph.hpp"
 #include "graphLoader.hpp"
 #include "embedder.hpp"
+#include "batch.hpp"
+#include "binaryGraph.hpp"
+#include "kuratowski.hpp"
+#include "dartIndex.hpp"
+#include "embeddingWriter.hpp"
+#include "resultCache.hpp"
 
+// usage: main [options] graph1.txt graph2.txt ...
+//   --threads N      threads used to embed each graph (to embed different graphs with --batch)
+//   --no-reduction   do not contract paths of nodes of degree 2
+//   --no-print       do not print graphs and embeddings
+//   --save FORMAT    save embeddings as embeddingN.txt (text) or embeddingN.emb (binary), without OGDF
+//   --svg            also draw embeddings and save them as embeddingN.svg
+//   --ogdf-layout    with --svg, lay out with OGDF instead (slow, not in builds without OGDF)
+//   --no-svg         do not save embeddings as svg (the default)
+//   --batch          one JSON line per graph, no printing
+//   --list FILE      with --batch, also embeds the graphs listed in FILE (one per line, - for stdin)
+//   --verify         also check the checksum and the symmetry of binary graph files
+//   --witness        for non planar graphs, find and check a subdivision of K5 or K3,3 (filters are skipped)
+//   --check          check each embedding (same edges as the graph, Euler formula) and count its faces
+//   --stats          load speed, time and counters of each phase of the embedder (to stderr, in the JSON line with --batch)
+//   --cache DIR      reuse the results of graphs already embedded, kept in DIR across runs
+//   --cache-size MB  bound on the size of the cache directory, least recently used results go first (1024)
+//   --convert IN OUT converts the graph in IN (text or binary) to a binary graph file OUT
 int main(int argc, char* argv[]) {
-    GraphLoader loader{};
-    Embedder embedder{};
-    int index = 0;
+    int numberOfThreads = 1;
+    bool isSeriesReductionEnabled = true;
+    bool isPrintEnabled = true;
+    bool isSvgEnabled = false;
+    bool isOgdfLayoutEnabled = false;
+    bool isBatch = false;
+    EmbeddingFormat format = EmbeddingFormat::None;
+    bool isBinaryVerificationEnabled = false;
+    bool isStatisticsEnabled = false;
+    bool isWitnessEnabled = false;
+    bool isCheckEnabled = false;
+    std::vector<std::string> convertPaths{};
+    std::string listPath{};
+    std::string cacheDirectory{};
+    uint64_t cacheMegabytes = 1024;
+    std::vector<std::string> paths{};
     for (int i = 1; i < argc; ++i) {
-        MyGraph graph = loader.loadFromFile(argv[i]);
-        std::cout << "graph:\n";
-        graph.print();
+        std::string argument(argv[i]);
+        if (argument == "--threads" && i+1 < argc) numberOfThreads = std::max(1, std::stoi(argv[++i]));
+        else if (argument == "--list" && i+1 < argc) listPath = argv[++i];
+        else if (argument == "--cache" && i+1 < argc) cacheDirectory = argv[++i];
+        else if (argument == "--cache-size" && i+1 < argc) cacheMegabytes = std::stoull(argv[++i]);
+        else if (argument == "--no-reduction") isSeriesReductionEnabled = false;
+        else if (argument == "--no-print") isPrintEnabled = false;
+        else if (argument == "--no-svg") isSvgEnabled = false;
+        else if (argument == "--svg") isSvgEnabled = true;
+        else if (argument == "--ogdf-layout") isOgdfLayoutEnabled = true;
+        else if (argument == "--save" && i+1 < argc) {
+            format = parseEmbeddingFormat(argv[++i]);
+            if (format == EmbeddingFormat::None) {
+                std::cerr << "Error: Unknown embedding format " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (argument == "--batch") isBatch = true;
+        else if (argument == "--verify") isBinaryVerificationEnabled = true;
+        else if (argument == "--stats") isStatisticsEnabled = true;
+        else if (argument == "--witness") isWitnessEnabled = true;
+        else if (argument == "--check") isCheckEnabled = true;
+        else if (argument == "--convert" && i+2 < argc) {
+            convertPaths.push_back(argv[++i]);
+            convertPaths.push_back(argv[++i]);
+        }
+        else paths.push_back(argument);
+    }
+#ifdef MY_WITHOUT_OGDF
+    if (isOgdfLayoutEnabled) {
+        std::cerr << "Error: Built without OGDF, embeddings cannot be laid out with OGDF" << std::endl;
+        return 1;
+    }
+#endif
+    if (!convertPaths.empty()) {
+        GraphLoader loader(numberOfThreads);
+        loader.setBinaryVerification(isBinaryVerificationEnabled);
+        const char* loadError{};
+        std::optional<MyGraph> graph = loader.loadFromFile(convertPaths[0].data(), loadError);
+        if (!graph) {
+            std::cerr << "Error: " << loadError << " " << convertPaths[0] << std::endl;
+            return 1;
+        }
+        if (!saveBinaryGraph(graph.value(), convertPaths[1].data())) {
+            std::cerr << "Error: Could not write file " << convertPaths[1] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (isBatch) {
+        BatchOptions options{};
+        options.numberOfThreads = numberOfThreads;
+        options.isSeriesReductionEnabled = isSeriesReductionEnabled;
+        options.isSvgEnabled = isSvgEnabled;
+        options.isOgdfLayoutEnabled = isOgdfLayoutEnabled;
+        options.format = format;
+        options.listPath = listPath;
+        options.isBinaryVerificationEnabled = isBinaryVerificationEnabled;
+        options.isStatisticsEnabled = isStatisticsEnabled;
+        options.isWitnessEnabled = isWitnessEnabled;
+        options.isCheckEnabled = isCheckEnabled;
+        options.cacheDirectory = cacheDirectory;
+        options.cacheBytes = cacheMegabytes << 20;
+        return runBatch(paths, options) == 0 ? 0 : 1;
+    }
+    GraphLoader loader(numberOfThreads);
+    loader.setBinaryVerification(isBinaryVerificationEnabled);
+    Embedder embedder(numberOfThreads);
+    embedder.setSeriesReduction(isSeriesReductionEnabled);
+    embedder.setStatistics(isStatisticsEnabled);
+    embedder.setWitnessExtraction(isWitnessEnabled);
+    std::unique_ptr<ResultCache> cache{};
+    if (!cacheDirectory.empty()) {
+        cache = std::make_unique<ResultCache>(cacheDirectory, cacheMegabytes << 20);
+        if (!cache->isOpen()) {
+            std::cerr << "Error: Could not open cache directory " << cacheDirectory << std::endl;
+            return 1;
+        }
+        embedder.setCache(cache.get());
+    }
+    int index = 0;
+    for (std::string& path : paths) {
+        const char* loadError{};
+        std::optional<MyGraph> loadedGraph = loader.loadFromFile(path.data(), loadError);
+        if (!loadedGraph) {
+            std::cerr << "Error: " << loadError << " " << path << std::endl;
+            return 1;
+        }
+        MyGraph& graph = loadedGraph.value();
+        if (isStatisticsEnabled) {
+            std::cerr << "loaded " << path << ": " << loader.getLastFileSize() << " bytes, "
+                      << loader.getLastThroughput() << " MB/s\n";
+        }
+        if (isPrintEnabled) {
+            std::cout << "graph:\n";
+            graph.print();
+        }
         std::optional<Embedding> embedding = embedder.embed(graph);
+        if (isStatisticsEnabled) {
+            std::cerr << "stats of " << path << ":\n";
+            embedder.getStatistics().print(std::cerr);
+        }
         std::cout << std::boolalpha << "graph is planar: " << embedding.has_value() << ".\n";
+        if (embedder.isLastResultCached()) std::cout << "result found in cache.\n";
+        if (embedder.getDecidingFilter() != PlanarityFilter::None)
+            std::cout << "rejected by filter: " << filterName(embedder.getDecidingFilter()) << ".\n";
+        if (!embedding.has_value() && isWitnessEnabled) {
+            const std::vector<std::pair<int, int>>& witness = embedder.getWitness();
+            const char* error = checkKuratowskiSubdivision(graph, witness);
+            if (error != nullptr) std::cout << "invalid witness: " << error << ".\n";
+            else {
+                std::cout << "witness: subdivision of " << kuratowskiGraphName(witness) << " with "
+                          << witness.size() << " edges.\n";
+                if (isPrintEnabled) {
+                    for (const auto& [from, to] : witness)
+                        std::cout << from << " " << to << "\n";
+                }
+            }
+        }
+        if (embedding.has_value() && isCheckEnabled) {
+            const char* error = checkEmbedding(graph, embedding.value());
+            if (error != nullptr) std::cout << "invalid embedding: " << error << ".\n";
+            else std::cout << "embedding checked: " << DartIndex(embedding.value()).numberOfFaces() << " faces.\n";
+        }
         if (embedding.has_value()) {
-            std::cout << "embedding:\n";
-            embedding.value().print();
-            std::string path = "embedding" + std::to_string(++index) + ".svg";
-            embedding.value().saveToSvg(path);
+            if (isPrintEnabled) {
+                std::cout << "embedding:\n";
+                embedding.value().print();
+            }
+            std::string outputPath = "embedding" + std::to_string(++index);
+            if (format != EmbeddingFormat::None) {
+                std::string path = outputPath + embeddingFileExtension(format);
+                if (!saveEmbedding(embedding.value(), format, path))
+                    std::cerr << "Error: Could not write file " << path << std::endl;
+            }
+            std::string svgPath = outputPath + ".svg";
+            if (isSvgEnabled) {
+                bool isSaved = isOgdfLayoutEnabled ? embedding.value().saveToOgdfSvg(svgPath) : embedding.value().saveToSvg(svgPath);
+                if (!isSaved) std::cerr << "Error: Could not write file " << svgPath << std::endl;
+            }
         }
         std::cout << "\n";
     }
+    if (cache != nullptr) cache->getStatistics().print(std::cerr);
     return 0;
 }
\ No newline at end of file
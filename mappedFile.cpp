@@ -0,0 +1,47 @@
+#include "mappedFile.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile(const char* path) {
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor == -1) return;
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode)) {
+        size_m = status.st_size;
+        if (size_m == 0) // mmap does not map empty files
+            isOpen_m = true;
+        else {
+            void* address = mmap(nullptr, size_m, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address != MAP_FAILED) {
+                data_m = static_cast<const char*>(address);
+                isOpen_m = true;
+            }
+        }
+    }
+    close(descriptor);
+}
+
+MappedFile::~MappedFile() {
+    if (data_m != nullptr)
+        munmap(const_cast<char*>(data_m), size_m);
+}
+
+void MappedFile::adviseSequential() const {
+    if (data_m != nullptr)
+        madvise(const_cast<char*>(data_m), size_m, MADV_SEQUENTIAL);
+}
+
+bool MappedFile::isOpen() const {
+    return isOpen_m;
+}
+
+const char* MappedFile::data() const {
+    return data_m;
+}
+
+size_t MappedFile::size() const {
+    return size_m;
+}
\ No newline at end of file
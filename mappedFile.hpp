@@ -0,0 +1,26 @@
+#ifndef MY_MAPPED_FILE_H
+#define MY_MAPPED_FILE_H
+
+#include <cstddef>
+
+// read only memory mapping of a whole file (unmapped on destruction)
+class MappedFile {
+private:
+    const char* data_m{nullptr};
+    size_t size_m{0};
+    bool isOpen_m{false};
+
+public:
+    MappedFile(const char* path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // the file will be read from start to end
+    void adviseSequential() const;
+    bool isOpen() const;
+    const char* data() const;
+    size_t size() const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,351 @@
+#include "planarDrawing.hpp"
+
+#include <cassert>
+#include <optional>
+#include <algorithm>
+#include <sstream>
+#include <span>
+
+#include "embedder.hpp"
+#include "dartIndex.hpp"
+#include "bufferedWriter.hpp"
+
+namespace {
+
+    // the first node found of every connected component but the first one is joined to the
+    // first node of the graph, the new edges go after the last neighbor of the nodes they join
+    // (components are then drawn next to each other); nullopt if the embedding is connected
+    std::optional<Embedding> connectComponents(const Embedding& embedding) {
+        std::vector<int> component(embedding.size(), -1);
+        std::vector<int> roots{};
+        std::vector<int> stack{};
+        for (int root = 0; root < embedding.size(); ++root) {
+            if (component[root] != -1) continue;
+            component[root] = roots.size();
+            roots.push_back(root);
+            stack.push_back(root);
+            while (!stack.empty()) {
+                int node = stack.back();
+                stack.pop_back();
+                for (int neighbor : embedding.getNeighborsOfNode(node)) {
+                    if (component[neighbor] != -1) continue;
+                    component[neighbor] = component[root];
+                    stack.push_back(neighbor);
+                }
+            }
+        }
+        if (roots.size() <= 1) return std::nullopt;
+        GraphBuilder builder(embedding.size());
+        builder.reserve(embedding.getNeighbors().size()+2*(roots.size()-1));
+        for (int node = 0; node < embedding.size(); ++node) {
+            for (int neighbor : embedding.getNeighborsOfNode(node))
+                builder.addSingleEdge(node, neighbor);
+            if (node == roots[0]) {
+                for (int i = 1; i < roots.size(); ++i)
+                    builder.addSingleEdge(node, roots[i]);
+            }
+            else if (roots[component[node]] == node) builder.addSingleEdge(node, roots[0]);
+        }
+        return Embedding(builder);
+    }
+
+    // every face with k > 3 darts c_0 -> c_1 -> ... -> c_{k-1} -> c_0 gets a cycle of k new nodes,
+    // x_i joined to c_i and c_{i+1}, and a new node z joined to all of them: all faces become
+    // triangles (c_i c_{i+1} x_i, c_{i+1} x_i x_{i+1} and x_i x_{i+1} z) and no parallel edges
+    // appear, even when a face goes through a node more than once (cut nodes).
+    // the outer face of the result is a face of the largest face of the embedding
+    struct Triangulation {
+        Embedding embedding;
+        int outerNodes[3];
+    };
+
+    Triangulation triangulate(const Embedding& embedding) {
+        DartIndex darts(embedding);
+        int largestFace = 0;
+        int numberOfNodes = embedding.size();
+        for (int face = 0; face < darts.numberOfFaces(); ++face) {
+            if (darts.getFaceSize(face) > darts.getFaceSize(largestFace)) largestFace = face;
+            if (darts.getFaceSize(face) > 3) numberOfNodes += darts.getFaceSize(face)+1;
+        }
+        // new neighbors of the tail of each dart, after the head of the dart in its rotation
+        std::vector<std::pair<int, int>> insertedAfter(darts.numberOfDarts(), {-1, -1});
+        GraphBuilder builder(numberOfNodes);
+        builder.reserve(embedding.getNeighbors().size()+8*(numberOfNodes-embedding.size()));
+        int outerNodes[3];
+        int firstNewNode = embedding.size();
+        for (int face = 0; face < darts.numberOfFaces(); ++face) {
+            std::span<const int> faceDarts = darts.getDartsOfFace(face);
+            int k = faceDarts.size();
+            if (k <= 3) {
+                if (face == largestFace) {
+                    for (int i = 0; i < 3; ++i)
+                        outerNodes[i] = darts.getTail(faceDarts[i]);
+                }
+                continue;
+            }
+            auto x = [&](int i) { return firstNewNode+(i+k)%k; };
+            int z = firstNewNode+k;
+            for (int i = 0; i < k; ++i) {
+                // the corner of the face at c_i is between the twin of d_{i-1} and d_i
+                insertedAfter[darts.getTwin(faceDarts[(i+k-1)%k])] = {x(i-1), x(i)};
+                builder.addSingleEdge(x(i), darts.getHead(faceDarts[i]));
+                builder.addSingleEdge(x(i), darts.getTail(faceDarts[i]));
+                builder.addSingleEdge(x(i), x(i-1));
+                builder.addSingleEdge(x(i), z);
+                builder.addSingleEdge(x(i), x(i+1));
+            }
+            for (int i = k-1; i >= 0; --i)
+                builder.addSingleEdge(z, x(i));
+            if (face == largestFace) {
+                outerNodes[0] = x(0);
+                outerNodes[1] = x(1);
+                outerNodes[2] = z;
+            }
+            firstNewNode += k+1;
+        }
+        for (int dart = 0; dart < darts.numberOfDarts(); ++dart) {
+            builder.addSingleEdge(darts.getTail(dart), darts.getHead(dart));
+            if (insertedAfter[dart].first == -1) continue;
+            builder.addSingleEdge(darts.getTail(dart), insertedAfter[dart].first);
+            builder.addSingleEdge(darts.getTail(dart), insertedAfter[dart].second);
+        }
+        return Triangulation{Embedding(builder), {outerNodes[0], outerNodes[1], outerNodes[2]}};
+    }
+
+    // canonical ordering of a triangulation with outer face first, second, last: nodes are removed
+    // from the outer cycle one at a time, starting from last, each time one without chords (edges
+    // between two nodes of the outer cycle that are not edges of the cycle); the order is the
+    // reverse of the removals. the outer cycle is kept as the path from first to second through
+    // the other outer nodes, and the neighbors of each node on it when it is removed are kept:
+    // they are the two nodes of the contour between which the node is added
+    struct CanonicalOrder {
+        std::vector<int> order{};
+        std::vector<int> left{};
+        std::vector<int> right{};
+    };
+
+    CanonicalOrder computeCanonicalOrder(const Embedding& triangulation, int first, int second, int last) {
+        int n = triangulation.size();
+        CanonicalOrder result{};
+        result.left.assign(n, -1);
+        result.right.assign(n, -1);
+        std::vector<int> prev(n, -1);
+        std::vector<int> next(n, -1);
+        std::vector<int> chords(n, 0);
+        std::vector<bool> isOuter(n, false);
+        std::vector<bool> isRemoved(n, false);
+        next[first] = last;
+        prev[last] = first;
+        next[last] = second;
+        prev[second] = last;
+        isOuter[first] = isOuter[second] = isOuter[last] = true;
+        std::vector<int> candidates{last};
+        std::vector<int> removed{};
+        removed.reserve(n);
+        while (removed.size() < n-2) {
+            assert(!candidates.empty());
+            int node = candidates.back();
+            candidates.pop_back();
+            if (isRemoved[node] || chords[node] != 0) continue;
+            int leftNode = prev[node];
+            int rightNode = next[node];
+            result.left[node] = leftNode;
+            result.right[node] = rightNode;
+            isRemoved[node] = true;
+            removed.push_back(node);
+            // the neighbors still there go, in one direction of the rotation, from leftNode to
+            // rightNode; in the other one are the removed neighbors (only last has none)
+            std::span<const int> neighbors = triangulation.getNeighborsOfNode(node);
+            int degree = neighbors.size();
+            int start = std::find(neighbors.begin(), neighbors.end(), leftNode)-neighbors.begin();
+            assert(start < degree);
+            int forward = neighbors[(start+1)%degree];
+            int backward = neighbors[(start+degree-1)%degree];
+            int step = isRemoved[forward] ? degree-1 : isRemoved[backward] ? 1 : forward == rightNode ? degree-1 : 1;
+            int previous = leftNode;
+            for (int i = (start+step)%degree; neighbors[i] != rightNode; i = (i+step)%degree) {
+                int inner = neighbors[i];
+                assert(!isOuter[inner] && !isRemoved[inner]);
+                next[previous] = inner;
+                prev[inner] = previous;
+                previous = inner;
+            }
+            next[previous] = rightNode;
+            prev[rightNode] = previous;
+            if (previous == leftNode) {
+                // the edge between leftNode and rightNode was a chord (unless it is first second)
+                if (leftNode != first || rightNode != second) {
+                    --chords[leftNode];
+                    --chords[rightNode];
+                }
+            }
+            for (int inner = next[leftNode]; inner != rightNode; inner = next[inner]) {
+                isOuter[inner] = true;
+                for (int neighbor : triangulation.getNeighborsOfNode(inner)) {
+                    if (!isOuter[neighbor] || isRemoved[neighbor]) continue;
+                    if (neighbor == prev[inner] || neighbor == next[inner]) continue;
+                    ++chords[inner];
+                    ++chords[neighbor];
+                }
+            }
+            for (int outer = leftNode; outer != next[rightNode]; outer = next[outer])
+                if (outer != first && outer != second && chords[outer] == 0) candidates.push_back(outer);
+        }
+        result.order.reserve(n);
+        result.order.push_back(first);
+        result.order.push_back(second);
+        result.order.insert(result.order.end(), removed.rbegin(), removed.rend());
+        return result;
+    }
+}
+
+// each node added is put at the intersection of the lines of slope 1 and -1 from the two ends
+// of the part of the contour it covers, after the nodes it covers are shifted right by one
+// and the ones after it by two. x offsets are relative to the parent in a tree where the
+// right child of a node is the next node of the contour (of the chain of covered nodes, once
+// it is covered) and the left child the first node it covers: shifting all the nodes after a
+// node of the contour is then changing one offset
+PlanarDrawing::PlanarDrawing(const Embedding& embedding) {
+    x_m.assign(embedding.size(), 0);
+    y_m.assign(embedding.size(), 0);
+    if (embedding.size() <= 2) {
+        if (embedding.size() == 2) x_m[1] = width_m = 1;
+        return;
+    }
+    std::optional<Embedding> connected = connectComponents(embedding);
+    Triangulation triangulation = triangulate(connected.has_value() ? connected.value() : embedding);
+    connected.reset();
+    const Embedding& triangulated = triangulation.embedding;
+    int n = triangulated.size();
+    CanonicalOrder canonicalOrder = computeCanonicalOrder(triangulated, triangulation.outerNodes[0],
+        triangulation.outerNodes[1], triangulation.outerNodes[2]);
+    const std::vector<int>& order = canonicalOrder.order;
+    std::vector<int> offset(n, 0);
+    std::vector<int> y(n, 0);
+    std::vector<int> leftChild(n, -1);
+    std::vector<int> rightChild(n, -1);
+    rightChild[order[0]] = order[2];
+    offset[order[2]] = 1;
+    y[order[2]] = 1;
+    rightChild[order[2]] = order[1];
+    offset[order[1]] = 1;
+    for (int k = 3; k < n; ++k) {
+        int node = order[k];
+        int left = canonicalOrder.left[node];
+        int right = canonicalOrder.right[node];
+        int firstCovered = rightChild[left];
+        ++offset[firstCovered];
+        ++offset[right];
+        int distance = 0;
+        int lastCovered = left;
+        for (int current = firstCovered; ; current = rightChild[current]) {
+            distance += offset[current];
+            if (current == right) break;
+            lastCovered = current;
+        }
+        assert((distance+y[right]-y[left])%2 == 0);
+        offset[node] = (distance+y[right]-y[left])/2;
+        y[node] = (distance+y[right]+y[left])/2;
+        offset[right] = distance-offset[node];
+        if (firstCovered != right) {
+            offset[firstCovered] -= offset[node];
+            leftChild[node] = firstCovered;
+            rightChild[lastCovered] = -1;
+        }
+        rightChild[left] = node;
+        rightChild[node] = right;
+    }
+    std::vector<int> x(n, 0);
+    std::vector<int> stack{order[0]};
+    while (!stack.empty()) {
+        int node = stack.back();
+        stack.pop_back();
+        for (int child : {leftChild[node], rightChild[node]}) {
+            if (child == -1) continue;
+            x[child] = x[node]+offset[child];
+            stack.push_back(child);
+        }
+    }
+    for (int node = 0; node < embedding.size(); ++node) {
+        x_m[node] = x[node];
+        y_m[node] = y[node];
+    }
+    width_m = 2*n-4;
+    height_m = n-2;
+}
+
+int PlanarDrawing::getX(int node) const {
+    return x_m[node];
+}
+
+int PlanarDrawing::getY(int node) const {
+    return y_m[node];
+}
+
+int PlanarDrawing::getWidth() const {
+    return width_m;
+}
+
+int PlanarDrawing::getHeight() const {
+    return height_m;
+}
+
+bool Embedding::saveToSvg(const std::string& path) const {
+    return saveDrawingToSvg(*this, PlanarDrawing(*this), path.data());
+}
+
+// one grid unit is scale pixels, up to a maximal size; lines and dots keep their size in
+// pixels whatever the scale (non scaling stroke), edges are split in several paths so that
+// no attribute is too big
+bool saveDrawingToSvg(const Embedding& embedding, const PlanarDrawing& drawing, const char* path) {
+    constexpr int maxLabeledNodes = 200;
+    constexpr int edgesPerPath = 10000;
+    BufferedWriter writer(path);
+    if (!writer.isGood()) return false;
+    int width = drawing.getWidth()+2;
+    int height = drawing.getHeight()+2;
+    double scale = std::clamp(4000.0/std::max(width, height), 0.01, 40.0);
+    std::ostringstream header{};
+    header << "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"-1 -1 " << width << " " << height
+           << "\" width=\"" << int(width*scale) << "\" height=\"" << int(height*scale) << "\">\n";
+    writer.writeText(header.str());
+    auto writePoint = [&](char command, int node) {
+        writer.writeText(std::string_view(&command, 1));
+        writer.writeNumber(drawing.getX(node), ' ');
+        writer.writeNumber(drawing.getHeight()-drawing.getY(node), ' ');
+    };
+    const char* pathStart = "<path fill=\"none\" stroke=\"black\" stroke-width=\"1\" vector-effect=\"non-scaling-stroke\" d=\"";
+    int edgesInPath = 0;
+    for (int node = 0; node < embedding.size(); ++node) {
+        for (int neighbor : embedding.getNeighborsOfNode(node)) {
+            if (neighbor < node) continue;
+            if (edgesInPath == 0) writer.writeText(pathStart);
+            writePoint('M', node);
+            writePoint('L', neighbor);
+            if (++edgesInPath == edgesPerPath) {
+                writer.writeText("\"/>\n");
+                edgesInPath = 0;
+            }
+        }
+    }
+    if (edgesInPath > 0) writer.writeText("\"/>\n");
+    // dots are round caps of segments of length 0
+    writer.writeText("<path fill=\"none\" stroke=\"steelblue\" stroke-width=\"6\" stroke-linecap=\"round\" vector-effect=\"non-scaling-stroke\" d=\"");
+    for (int node = 0; node < embedding.size(); ++node) {
+        writePoint('M', node);
+        writer.writeText("h0 ");
+    }
+    writer.writeText("\"/>\n");
+    if (embedding.size() <= maxLabeledNodes) {
+        std::ostringstream labels{};
+        labels << "<g font-family=\"sans-serif\" font-size=\"" << 12/scale << "\">\n";
+        for (int node = 0; node < embedding.size(); ++node) {
+            labels << "<text x=\"" << drawing.getX(node)+6/scale << "\" y=\"" << drawing.getHeight()-drawing.getY(node)-6/scale
+                   << "\">" << node << "</text>\n";
+        }
+        labels << "</g>\n";
+        writer.writeText(labels.str());
+    }
+    writer.writeText("</svg>\n");
+    return writer.close();
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef MY_PLANAR_DRAWING_H
+#define MY_PLANAR_DRAWING_H
+
+#include <vector>
+
+class Embedding;
+
+// straight line drawing of an embedding on an integer grid, in linear time: the embedding is
+// connected and triangulated with extra nodes inside its faces (not part of the drawing), then
+// its nodes are placed in a canonical order as de Fraysseix, Pach and Pollack, with the
+// shifts done by keeping x coordinates relative to other nodes as Chrobak and Payne.
+// for N nodes after triangulation the grid is (2N-4) x (N-2)
+class PlanarDrawing {
+private:
+    std::vector<int> x_m{};
+    std::vector<int> y_m{};
+    int width_m{0};
+    int height_m{0};
+
+public:
+    PlanarDrawing(const Embedding& embedding);
+
+    int getX(int node) const;
+    // grows upwards
+    int getY(int node) const;
+    int getWidth() const;
+    int getHeight() const;
+};
+
+// streamed: edges as straight lines, nodes as dots (with their labels for small graphs);
+// false if the file could not be written
+bool saveDrawingToSvg(const Embedding& embedding, const PlanarDrawing& drawing, const char* path);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include "planarityFilter.hpp"
+
+#include "graph.hpp"
+
+const char* filterName(PlanarityFilter filter) {
+    switch (filter) {
+        case PlanarityFilter::None: return "none";
+        case PlanarityFilter::GlobalEdgeBound: return "global edge bound";
+        case PlanarityFilter::ComponentEdgeBound: return "component edge bound";
+        case PlanarityFilter::BipartiteEdgeBound: return "bipartite edge bound";
+        case PlanarityFilter::SegmentEdgeBound: return "segment edge bound";
+    }
+    return "unknown";
+}
+
+bool exceedsEdgeBound(const MyGraph& graph) {
+    if (graph.size() < 3) return false;
+    return graph.numberOfEdges() > 3*graph.size()-6;
+}
+
+// the bipartition costs a visit of the graph, it is computed only if the bound can fail
+bool exceedsBipartiteEdgeBound(const MyGraph& graph) {
+    if (graph.size() < 3) return false;
+    if (graph.numberOfEdges() <= 2*graph.size()-4) return false;
+    return graph.computeBipartition().has_value();
+}
\ No newline at end of file
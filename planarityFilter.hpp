@@ -0,0 +1,23 @@
+#ifndef MY_PLANARITY_FILTER_H
+#define MY_PLANARITY_FILTER_H
+
+class MyGraph;
+
+// cheap necessary conditions for planarity, tried before (and during) the decomposition:
+// when one fails the graph is non planar and the rest of the algorithm is skipped
+enum class PlanarityFilter {
+    None, // nothing was rejected by a filter
+    GlobalEdgeBound, // whole graph has more than 3n-6 edges
+    ComponentEdgeBound, // a biconnected component has more than 3n-6 edges
+    BipartiteEdgeBound, // a bipartite biconnected component has more than 2n-4 edges
+    SegmentEdgeBound, // a segment (with its contracted cycle) has more than 3n-6 edges
+};
+
+const char* filterName(PlanarityFilter filter);
+
+// graphs are simple: a planar graph with n >= 3 nodes has at most 3n-6 edges,
+// at most 2n-4 if it has no triangles (for instance if it is bipartite)
+bool exceedsEdgeBound(const MyGraph& graph);
+bool exceedsBipartiteEdgeBound(const MyGraph& graph);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "resultCache.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <system_error>
+#include <vector>
+#include <unistd.h>
+
+#include "mappedFile.hpp"
+#include "bufferedWriter.hpp"
+#include "dartIndex.hpp"
+
+namespace {
+    constexpr const char* entryExtension = ".result";
+
+    // finalizer of splitmix64
+    uint64_t mix(uint64_t value) {
+        value = (value ^ (value >> 30))*0xbf58476d1ce4e5b9;
+        value = (value ^ (value >> 27))*0x94d049bb133111eb;
+        return value ^ (value >> 31);
+    }
+
+    // offsets starting at 0, never decreasing, ending at the number of neighbors
+    bool hasValidOffsets(std::span<const int> offsets, uint64_t numberOfHalfEdges) {
+        if (offsets.front() != 0 || uint64_t(offsets.back()) != numberOfHalfEdges) return false;
+        for (size_t i = 1; i < offsets.size(); ++i)
+            if (offsets[i-1] > offsets[i]) return false;
+        return true;
+    }
+}
+
+std::string GraphHash::toString() const {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        text[15-i] = digits[(high >> 4*i) & 15];
+        text[31-i] = digits[(low >> 4*i) & 15];
+    }
+    return text;
+}
+
+// the hashes of the edges are summed, so the order they are seen in does not matter
+GraphHash computeGraphHash(const MyGraph& graph) {
+    GraphHash hash{mix(uint64_t(graph.size())), mix(~uint64_t(graph.size()))};
+    for (int node = 0; node < graph.size(); ++node) {
+        for (int neighbor : graph.getNeighborsOfNode(node)) {
+            if (neighbor < node) continue;
+            uint64_t edge = uint64_t(node) << 32 | uint32_t(neighbor);
+            hash.low += mix(edge);
+            hash.high += mix(edge ^ 0x9e3779b97f4a7c15);
+        }
+    }
+    return hash;
+}
+
+void ResultCacheStats::print(std::ostream& output) const {
+    output << "cache: " << hits << " hits, " << misses << " misses, " << stores << " stored, "
+           << evictions << " evicted, " << rejected << " rejected, " << entries << " entries, "
+           << bytes << " bytes\n";
+}
+
+void ResultCacheStats::writeJson(std::ostream& output) const {
+    output << "{\"hits\":" << hits << ",\"misses\":" << misses << ",\"stores\":" << stores
+           << ",\"evictions\":" << evictions << ",\"rejected\":" << rejected
+           << ",\"entries\":" << entries << ",\"bytes\":" << bytes << "}";
+}
+
+ResultCache::ResultCache(const std::string& directory, uint64_t maxBytes) : directory_m(directory), maxBytes_m(maxBytes) {
+    std::error_code error;
+    std::filesystem::create_directories(directory_m, error);
+    if (!std::filesystem::is_directory(directory_m, error)) return;
+    std::vector<std::pair<std::filesystem::file_time_type, std::string>> files{};
+    for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(directory_m, error)) {
+        if (!file.is_regular_file(error) || file.path().extension() != entryExtension) continue;
+        std::filesystem::file_time_type time = file.last_write_time(error);
+        uint64_t size = file.file_size(error);
+        if (error) continue;
+        files.emplace_back(time, file.path().filename().string());
+        entries_m[files.back().second].size = size;
+        stats_m.bytes += size;
+    }
+    std::sort(files.begin(), files.end(), std::greater<>());
+    for (const auto& [time, name] : files) {
+        recentlyUsed_m.push_back(name);
+        entries_m[name].position = std::prev(recentlyUsed_m.end());
+    }
+    stats_m.entries = entries_m.size();
+    evict();
+}
+
+std::string ResultCache::pathOf(const std::string& name) const {
+    return directory_m + "/" + name;
+}
+
+bool ResultCache::isOpen() const {
+    std::error_code error;
+    return std::filesystem::is_directory(directory_m, error);
+}
+
+// with mutex_m held
+void ResultCache::removeEntry(const std::string& name) {
+    auto entry = entries_m.find(name);
+    if (entry == entries_m.end()) return;
+    std::error_code error;
+    std::filesystem::remove(pathOf(name), error);
+    stats_m.bytes -= entry->second.size;
+    recentlyUsed_m.erase(entry->second.position);
+    entries_m.erase(entry);
+    stats_m.entries = entries_m.size();
+}
+
+// with mutex_m held
+void ResultCache::evict() {
+    while (stats_m.bytes > maxBytes_m && !recentlyUsed_m.empty()) {
+        removeEntry(recentlyUsed_m.back());
+        ++stats_m.evictions;
+    }
+}
+
+std::optional<CachedResult> ResultCache::find(const MyGraph& graph, const GraphHash& hash) {
+    const std::string name = hash.toString()+entryExtension;
+    auto file = std::make_shared<const MappedFile>(pathOf(name).data());
+    ResultCacheHeader header{};
+    bool isValid = file->isOpen() && file->size() >= sizeof(header);
+    if (isValid) {
+        std::memcpy(&header, file->data(), sizeof(header));
+        isValid = std::memcmp(header.magic, resultCacheMagic, sizeof(resultCacheMagic)) == 0
+            && header.version == resultCacheVersion && header.headerSize == sizeof(header)
+            && header.hashLow == hash.low && header.hashHigh == hash.high
+            && header.numberOfNodes == uint64_t(graph.size()) && header.numberOfEdges == uint64_t(graph.numberOfEdges())
+            && header.filter <= static_cast<uint32_t>(PlanarityFilter::SegmentEdgeBound);
+    }
+    std::optional<CachedResult> result{};
+    if (isValid && header.isPlanar == 0) {
+        result.emplace();
+        result->filter = static_cast<PlanarityFilter>(header.filter);
+    }
+    else if (isValid) {
+        size_t arraysSize = (header.numberOfNodes+1+2*header.numberOfEdges)*sizeof(int);
+        if (file->size() == sizeof(header)+arraysSize) {
+            const int* offsets = reinterpret_cast<const int*>(file->data()+sizeof(header));
+            std::span<const int> offsetsView(offsets, header.numberOfNodes+1);
+            std::span<const int> neighborsView(offsets+header.numberOfNodes+1, 2*header.numberOfEdges);
+            if (hasValidOffsets(offsetsView, neighborsView.size())) {
+                const MappedFile* data = file.get();
+                Embedding embedding(MyGraph(graph.size(), offsetsView, neighborsView,
+                    std::shared_ptr<const void>(file, data)));
+                if (checkEmbedding(graph, embedding) == nullptr) {
+                    result.emplace();
+                    result->embedding = std::move(embedding);
+                }
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_m);
+    auto entry = entries_m.find(name);
+    if (!result.has_value()) {
+        ++stats_m.misses;
+        // whatever is there belongs to another graph or is damaged
+        if (file->isOpen()) {
+            ++stats_m.rejected;
+            if (entry != entries_m.end()) removeEntry(name);
+            else {
+                std::error_code error;
+                std::filesystem::remove(pathOf(name), error);
+            }
+        }
+        return std::nullopt;
+    }
+    ++stats_m.hits;
+    if (entry != entries_m.end())
+        recentlyUsed_m.splice(recentlyUsed_m.begin(), recentlyUsed_m, entry->second.position);
+    else { // written by another process
+        recentlyUsed_m.push_front(name);
+        entries_m[name] = Entry{file->size(), recentlyUsed_m.begin()};
+        stats_m.bytes += file->size();
+        stats_m.entries = entries_m.size();
+    }
+    std::error_code error;
+    std::filesystem::last_write_time(pathOf(name), std::filesystem::file_time_type::clock::now(), error);
+    evict();
+    return result;
+}
+
+void ResultCache::store(const MyGraph& graph, const GraphHash& hash, const std::optional<Embedding>& embedding,
+PlanarityFilter filter) {
+    ResultCacheHeader header{};
+    std::memcpy(header.magic, resultCacheMagic, sizeof(resultCacheMagic));
+    header.version = resultCacheVersion;
+    header.headerSize = sizeof(ResultCacheHeader);
+    header.hashLow = hash.low;
+    header.hashHigh = hash.high;
+    header.numberOfNodes = graph.size();
+    header.numberOfEdges = graph.numberOfEdges();
+    header.isPlanar = embedding.has_value();
+    header.filter = static_cast<uint32_t>(filter);
+    uint64_t size = sizeof(header);
+    if (embedding.has_value()) {
+        assert(embedding.value().getNeighbors().size() == 2*header.numberOfEdges);
+        size += embedding.value().getOffsets().size_bytes()+embedding.value().getNeighbors().size_bytes();
+    }
+    if (size > maxBytes_m) return;
+    const std::string name = hash.toString()+entryExtension;
+    std::string temporaryPath{};
+    {
+        std::lock_guard<std::mutex> lock(mutex_m);
+        temporaryPath = pathOf(name+".tmp"+std::to_string(getpid())+"-"+std::to_string(temporaryFiles_m++));
+    }
+    BufferedWriter output(temporaryPath.data());
+    output.writeBytes(&header, sizeof(header));
+    if (embedding.has_value()) {
+        output.writeBytes(embedding.value().getOffsets().data(), embedding.value().getOffsets().size_bytes());
+        output.writeBytes(embedding.value().getNeighbors().data(), embedding.value().getNeighbors().size_bytes());
+    }
+    std::error_code error;
+    if (!output.close()) {
+        std::filesystem::remove(temporaryPath, error);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_m);
+    std::filesystem::rename(temporaryPath, pathOf(name), error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return;
+    }
+    auto entry = entries_m.find(name);
+    if (entry != entries_m.end()) {
+        stats_m.bytes -= entry->second.size;
+        recentlyUsed_m.erase(entry->second.position);
+    }
+    recentlyUsed_m.push_front(name);
+    entries_m[name] = Entry{size, recentlyUsed_m.begin()};
+    stats_m.bytes += size;
+    stats_m.entries = entries_m.size();
+    ++stats_m.stores;
+    evict();
+}
+
+ResultCacheStats ResultCache::getStatistics() {
+    std::lock_guard<std::mutex> lock(mutex_m);
+    return stats_m;
+}
\ No newline at end of file
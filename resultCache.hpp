@@ -0,0 +1,109 @@
+#ifndef MY_RESULT_CACHE_H
+#define MY_RESULT_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "graph.hpp"
+#include "embedder.hpp"
+#include "planarityFilter.hpp"
+
+// 128 bit hash of the number of nodes and of the set of edges of a graph, each edge taken as
+// (smaller end, bigger end): it does not depend on the order of the edges nor of the neighbors
+struct GraphHash {
+    uint64_t low{};
+    uint64_t high{};
+
+    bool operator==(const GraphHash& other) const = default;
+    // 32 hexadecimal digits
+    std::string toString() const;
+};
+
+GraphHash computeGraphHash(const MyGraph& graph);
+
+// cache entry file (native little endian): a ResultCacheHeader, then for a planar graph the
+// CSR arrays of its embedding as 32 bit integers, the offsets (numberOfNodes+1) and the
+// neighbors (2*numberOfEdges)
+struct ResultCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t hashLow;
+    uint64_t hashHigh;
+    uint64_t numberOfNodes;
+    uint64_t numberOfEdges;
+    uint32_t isPlanar;
+    uint32_t filter; // PlanarityFilter that proved the graph non planar
+};
+
+constexpr char resultCacheMagic[8] = {'M', 'Y', 'R', 'E', 'S', 'U', 'L', 'T'};
+constexpr uint32_t resultCacheVersion = 1;
+
+struct CachedResult {
+    // nullopt for a non planar graph
+    std::optional<Embedding> embedding{};
+    PlanarityFilter filter{PlanarityFilter::None};
+};
+
+struct ResultCacheStats {
+    long long hits{0};
+    long long misses{0};
+    long long stores{0};
+    long long evictions{0};
+    // entries found but not matching their graph (hash collision or damaged file), removed
+    long long rejected{0};
+    long long entries{0};
+    uint64_t bytes{0};
+
+    void print(std::ostream& output) const;
+    void writeJson(std::ostream& output) const;
+};
+
+// results of Embedder kept on disk across runs: a directory with one file per graph, named by
+// its GraphHash. planar results are memory mapped when found and their embedding uses the
+// file directly, after checking it against the graph (checkEmbedding), so a hash collision
+// can only go unnoticed for non planar graphs with the same numbers of nodes and edges.
+// the total size of the files is bounded, the least recently used ones are removed first
+// (a hit touches its file, so the order survives between runs).
+// safe to share between threads; processes sharing a directory only see each other's files
+// on a miss (entries are written to a temporary file and renamed)
+class ResultCache {
+private:
+    struct Entry {
+        uint64_t size;
+        std::list<std::string>::iterator position;
+    };
+
+    std::string directory_m;
+    uint64_t maxBytes_m;
+    std::mutex mutex_m{};
+    // file names, most recently used first
+    std::list<std::string> recentlyUsed_m{};
+    std::unordered_map<std::string, Entry> entries_m{};
+    ResultCacheStats stats_m{};
+    long long temporaryFiles_m{0};
+
+    std::string pathOf(const std::string& name) const;
+    void removeEntry(const std::string& name);
+    void evict();
+
+public:
+    // creates the directory if needed and indexes the entries already in it
+    ResultCache(const std::string& directory, uint64_t maxBytes);
+
+    bool isOpen() const;
+    // nullopt on a miss
+    std::optional<CachedResult> find(const MyGraph& graph, const GraphHash& hash);
+    // embedding is the result for graph, filter the deciding filter if it is not planar;
+    // results bigger than the whole cache are not stored
+    void store(const MyGraph& graph, const GraphHash& hash, const std::optional<Embedding>& embedding,
+        PlanarityFilter filter);
+    ResultCacheStats getStatistics();
+};
+
+#endif
\ No newline at end of file
@@ -2,29 +2,52 @@
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 
 #include "utils.hpp"
 
-Segment::Segment(int numberOfNodes, const Component& component, const Cycle& cycle)
-: Component(numberOfNodes, component), originalComponent_m(component), originalCycle_m(cycle) {
-    isNodeAnAttachment_m.resize(numberOfNodes);
-    for (int i = 0; i < numberOfNodes; ++i)
-        isNodeAnAttachment_m[i] = false;
+Segment::Segment(const GraphBuilder& builder, const Component& component, const Cycle& cycle,
+std::vector<int> attachments, int numberOfOwnNodes)
+: Component(builder, component), attachments_m(std::move(attachments)), numberOfOwnNodes_m(numberOfOwnNodes),
+originalComponent_m(component), originalCycle_m(cycle) {
+    assert(attachments_m.size() >= 2);
 }
 
-void Segment::addAttachment(int attachment) {
-    if (isNodeAnAttachment(attachment)) return;
-    isNodeAnAttachment_m[attachment] = true;
-    attachmentNodes_m.push_back(attachment);
+bool Segment::isNodeAnAttachment(int node) const {
+    return node < attachments_m.size();
 }
 
-bool Segment::isNodeAnAttachment(int node) const {
-    return isNodeAnAttachment_m[node];
+bool Segment::isNodeADummy(int node) const {
+    return node >= attachments_m.size()+numberOfOwnNodes_m;
+}
+
+// returns the attachment placed at the given position of the cycle, -1 if there is none
+int Segment::getAttachmentOfCycleNode(int cycleNode) const {
+    auto it = std::lower_bound(attachments_m.begin(), attachments_m.end(), cycleNode);
+    if (it == attachments_m.end() || *it != cycleNode) return -1;
+    return it-attachments_m.begin();
+}
+
+// next and prev along the contracted cycle: 0, 1, ..., k-1 or 0, dummy, 1, dummy
+int Segment::getNextOfAttachment(int attachment) const {
+    assert(isNodeAnAttachment(attachment));
+    if (attachments_m.size() == 2) return size()-2+attachment;
+    return (attachment+1) % attachments_m.size();
+}
+
+int Segment::getPrevOfAttachment(int attachment) const {
+    assert(isNodeAnAttachment(attachment));
+    if (attachments_m.size() == 2) return size()-1-attachment;
+    return (attachment+attachments_m.size()-1) % attachments_m.size();
+}
+
+bool Segment::isChord() const {
+    return attachments_m.size() == 2 && numberOfOwnNodes_m == 0;
 }
 
 bool Segment::isPath() const {
-    for (int node = 0; node < size(); ++node) {
-        if (isNodeAnAttachment(node)) continue;
+    for (int node = attachments_m.size(); node < size(); ++node) {
+        if (isNodeADummy(node)) continue;
         if (getNeighborsOfNode(node).size() > 2)
             return false;
     }
@@ -32,39 +55,7 @@ bool Segment::isPath() const {
 }
 
 const std::vector<int>& Segment::getAttachments() const {
-    return attachmentNodes_m;
-}
-
-std::list<int> Segment::computePathBetweenAttachments(int start, int end) const {
-    assert(isNodeAnAttachment(start));
-    assert(isNodeAnAttachment(end));
-    int prevOfNode[size()];
-    for (int node = 0; node < size(); ++node)
-        prevOfNode[node] = -1;
-    std::list<int> queue{};
-    queue.push_back(start);
-    while (queue.size() != 0) {
-        int node = queue.front();
-        queue.pop_front();
-        for (const int neighbor : getNeighborsOfNode(node)) {
-            if (originalCycle_m.hasNode(getLabelOfNode(node)) && originalCycle_m.hasNode(getLabelOfNode(neighbor)))
-                continue;
-            if (prevOfNode[neighbor] == -1) {
-                prevOfNode[neighbor] = node;
-                queue.push_back(neighbor);
-                if (neighbor == end) break;
-            }
-        }
-        if (prevOfNode[end] != -1) break;
-    }
-    std::list<int> path{};
-    int crawl = end;
-    while (crawl != start) {
-        path.push_front(crawl);
-        crawl = prevOfNode[crawl];
-    }
-    path.push_front(crawl);
-    return path;
+    return attachments_m;
 }
 
 const Cycle& Segment::getOriginalCycle() const {
@@ -75,113 +66,234 @@ const Component& Segment::getOriginalComponent() const {
     return originalComponent_m;
 }
 
-SegmentsHandler::SegmentsHandler(const Component& component, const Cycle& cycle)
-: originalComponent_m(component), originalCycle_m(cycle) {
+SegmentsHandler::SegmentsHandler(const Component& component, const Cycle& cycle, EmbedderWorkspace& workspace)
+: originalCycle_m(cycle), originalComponent_m(component), workspace_m(workspace) {
     findSegments();
-    findChords();
+    if (!isCycleBad_m) findChords();
 }
 
-void SegmentsHandler::dfsFindSegments(int node, bool isNodeVisited[], std::vector<int>& nodesInSegment,
+SegmentsHandler::SegmentsHandler(const Component& component, const Cycle& cycle, const std::vector<int>& nodes,
+EmbedderWorkspace& workspace)
+: originalCycle_m(cycle), originalComponent_m(component), workspace_m(workspace) {
+    EpochMarker& isNodeVisited = workspace_m.visited;
+    isNodeVisited.reset(originalComponent_m.size());
+    for (const int node : nodes)
+        if (!originalCycle_m.hasNode(node) && !isNodeVisited.isMarked(node)) findSegmentOfNode(node);
+    if (isCycleBad_m) return;
+    for (const int node : nodes)
+        if (originalCycle_m.hasNode(node)) findChordsOfNode(node);
+}
+
+// dfsStack holds pairs (node, index of the next neighbor of node to look at)
+void SegmentsHandler::dfsFindSegments(int node, std::vector<int>& nodesInSegment,
 std::vector<std::pair<int, int>>& edgesInSegment) {
+    EpochMarker& isNodeVisited = workspace_m.visited;
+    std::vector<std::pair<int, int>>& dfsStack = workspace_m.segmentDfsStack;
     nodesInSegment.push_back(node);
-    isNodeVisited[node] = true;
-    for (const int neighbor : originalComponent_m.getNeighborsOfNode(node)) {
+    isNodeVisited.mark(node);
+    dfsStack.push_back(std::make_pair(node, 0));
+    while (dfsStack.size() > 0) {
+        node = dfsStack.back().first;
+        std::span<const int> neighbors = originalComponent_m.getNeighborsOfNode(node);
+        if (dfsStack.back().second == neighbors.size()) {
+            dfsStack.pop_back();
+            continue;
+        }
+        int neighbor = neighbors[dfsStack.back().second++];
         if (originalCycle_m.hasNode(neighbor)) {
             edgesInSegment.push_back(std::make_pair(node, neighbor));
             continue;
         }
         if (node < neighbor)
             edgesInSegment.push_back(std::make_pair(node, neighbor));
-        if (!isNodeVisited[neighbor])
-            dfsFindSegments(neighbor, isNodeVisited, nodesInSegment, edgesInSegment);
+        if (!isNodeVisited.isMarked(neighbor)) {
+            nodesInSegment.push_back(neighbor);
+            isNodeVisited.mark(neighbor);
+            dfsStack.push_back(std::make_pair(neighbor, 0));
+        }
     }
 }
 
 void SegmentsHandler::findChords() {
-    for (int i = 0; i < originalCycle_m.size(); ++i) {
-        int node = originalCycle_m.nodes()[i];
-        for (const int neighbor : originalComponent_m.getNeighborsOfNode(node)) {
-            if (node < neighbor) continue;
-            if (originalCycle_m.hasNode(neighbor))
-                if (neighbor != originalCycle_m.getPrevOfNode(node) && neighbor != originalCycle_m.getNextOfNode(node))
-                    segments_m.push_back(buildChord(node, neighbor));
-        }
+    for (int i = 0; i < originalCycle_m.size(); ++i)
+        findChordsOfNode(originalCycle_m.nodes()[i]);
+}
+
+// chords from the cycle node node to smaller cycle nodes
+void SegmentsHandler::findChordsOfNode(int node) {
+    for (const int neighbor : originalComponent_m.getNeighborsOfNode(node)) {
+        if (node < neighbor) continue;
+        if (originalCycle_m.hasNode(neighbor))
+            if (neighbor != originalCycle_m.getPrevOfNode(node) && neighbor != originalCycle_m.getNextOfNode(node))
+                buildChord(node, neighbor);
     }
 }
 
 void SegmentsHandler::findSegments() {
-    bool isNodeVisited[originalComponent_m.size()];
-    for (int node = 0; node < originalComponent_m.size(); ++node)
-        isNodeVisited[node] = false;
+    EpochMarker& isNodeVisited = workspace_m.visited;
+    isNodeVisited.reset(originalComponent_m.size());
+    for (const int node : originalCycle_m.nodes())
+        isNodeVisited.mark(node);
     for (int node = 0; node < originalComponent_m.size(); ++node)
-        if (originalCycle_m.hasNode(node))
-            isNodeVisited[node] = true;    
-    for (int node = 0; node < originalComponent_m.size(); ++node) {
-        if (!isNodeVisited[node]) {
-            std::vector<int> nodes{}; // does NOT contain cycle nodes
-            std::vector<std::pair<int, int>> edges{}; // does NOT contain edges of the cycle
-            dfsFindSegments(node, isNodeVisited, nodes, edges);
-            segments_m.push_back(buildSegment(nodes, edges));
-        }
-    }
+        if (!isNodeVisited.isMarked(node)) findSegmentOfNode(node);
 }
 
-// nodes vector does NOT contain cycle nodes
-// edges vector does NOT contain cycle edges
-Segment SegmentsHandler::buildSegment(std::vector<int>& nodes, std::vector<std::pair<int, int>>& edges) {
-    Segment segment(nodes.size()+originalCycle_m.size(), originalComponent_m, originalCycle_m);
-    // assigning labels
-    // first nodes MUST be the same of the cycle in the SAME ORDER
-    int oldToNewLabel[originalComponent_m.size()];
-    for (int i = 0; i < originalCycle_m.size(); ++i) {
-        int cycleNode = originalCycle_m.nodes()[i];
-        oldToNewLabel[cycleNode] = i;
-        segment.assignNodeLabel(i, cycleNode);
+// builds the segment containing node, which is not in the cycle nor visited
+void SegmentsHandler::findSegmentOfNode(int node) {
+    std::vector<int>& nodes = workspace_m.segmentNodes; // does NOT contain cycle nodes
+    std::vector<std::pair<int, int>>& edges = workspace_m.segmentEdges; // does NOT contain edges of the cycle
+    nodes.clear();
+    edges.clear();
+    dfsFindSegments(node, nodes, edges);
+    if (isOnlySegment(nodes, edges) && !isPath(nodes)) {
+        isCycleBad_m = true;
+        badSegmentNodes_m = nodes;
+        badSegmentAttachments_m = computeAttachments(edges);
+        return;
     }
-    for (int i = 0; i < nodes.size(); ++i) { // remember that nodes does not include cycle nodes
-        int node = nodes[i];
-        oldToNewLabel[node] = i+originalCycle_m.size();
-        segment.assignNodeLabel(i+originalCycle_m.size(), node);
-    }
-    // adding edges
+    buildSegment(nodes, edges);
+}
+
+// no other segment nor chord: every node and edge not in the cycle is in this segment
+bool SegmentsHandler::isOnlySegment(const std::vector<int>& nodes, const std::vector<std::pair<int, int>>& edges) const {
+    return segments_m.empty() && nodes.size()+originalCycle_m.size() == originalComponent_m.size()
+        && edges.size()+originalCycle_m.size() == originalComponent_m.numberOfEdges();
+}
+
+// the nodes of a segment are not in the cycle, so their degree is the same in the segment
+bool SegmentsHandler::isPath(const std::vector<int>& nodes) const {
+    for (const int node : nodes)
+        if (originalComponent_m.getNeighborsOfNode(node).size() > 2) return false;
+    return true;
+}
+
+// positions in the cycle of the ends of edges in the cycle, increasing
+std::vector<int> SegmentsHandler::computeAttachments(const std::vector<std::pair<int, int>>& edges) const {
+    std::vector<int> attachments{};
     for (auto& edge : edges) {
-        int from = oldToNewLabel[edge.first];
-        int to = oldToNewLabel[edge.second];
-        segment.addEdge(from, to);
-        // adding attachment
         if (originalCycle_m.hasNode(edge.first))
-            segment.addAttachment(from);
+            attachments.push_back(originalCycle_m.getIndexOfNode(edge.first).value());
         if (originalCycle_m.hasNode(edge.second))
-            segment.addAttachment(to);
+            attachments.push_back(originalCycle_m.getIndexOfNode(edge.second).value());
     }
-    // adding cycle edges
-    for (int i = 0; i < originalCycle_m.size()-1; ++i)
-        segment.addEdge(i, i+1);
-    segment.addEdge(0, originalCycle_m.size()-1);
-    return segment;
+    std::sort(attachments.begin(), attachments.end());
+    attachments.erase(std::unique(attachments.begin(), attachments.end()), attachments.end());
+    return attachments;
 }
 
-Segment SegmentsHandler::buildChord(int attachment1, int attachment2) {
-    Segment chord(originalCycle_m.size(), originalComponent_m, originalCycle_m);
-    // assigning labels
-    // first nodes MUST be the same of the cycle in the SAME ORDER
-    for (int i = 0; i < originalCycle_m.size(); ++i)
-        chord.assignNodeLabel(i, originalCycle_m.nodes()[i]);
-    // adding cycle edges
-    for (int i = 0; i < originalCycle_m.size()-1; ++i)
-        chord.addEdge(i, i+1);
-    chord.addEdge(0, originalCycle_m.size()-1);
-    // adding chord edge
+// nodes vector does NOT contain cycle nodes
+// edges vector does NOT contain cycle edges
+void SegmentsHandler::buildSegment(const std::vector<int>& nodes, const std::vector<std::pair<int, int>>& edges) {
+    std::vector<int> attachments = computeAttachments(edges);
+    // assigning labels: attachments first (in cycle order), then the other nodes
+    workspace_m.reserveNodes(originalComponent_m.size());
+    std::vector<int>& oldToNewLabel = workspace_m.nodeMap;
+    for (int i = 0; i < attachments.size(); ++i)
+        oldToNewLabel[originalCycle_m.nodes()[attachments[i]]] = i;
+    for (int i = 0; i < nodes.size(); ++i) // remember that nodes does not include cycle nodes
+        oldToNewLabel[nodes[i]] = i+attachments.size();
+    GraphBuilder builder(attachments.size()+nodes.size());
+    builder.reserve(2*(edges.size()+attachments.size()+2));
+    addContractedCycle(builder, attachments.size());
+    for (auto& edge : edges)
+        builder.addEdge(oldToNewLabel[edge.first], oldToNewLabel[edge.second]);
+    addSegment(builder, attachments, nodes);
+}
+
+void SegmentsHandler::buildChord(int attachment1, int attachment2) {
     std::optional<int> from = originalCycle_m.getIndexOfNode(attachment1);
     std::optional<int> to = originalCycle_m.getIndexOfNode(attachment2);
     assert(from);
     assert(to);
-    chord.addEdge(from.value(), to.value());
-    chord.addAttachment(from.value());
-    chord.addAttachment(to.value());
-    return chord;
+    std::vector<int> attachments{std::min(from.value(), to.value()), std::max(from.value(), to.value())};
+    GraphBuilder builder(2);
+    builder.reserve(2*5);
+    addContractedCycle(builder, 2);
+    builder.addEdge(0, 1);
+    addSegment(builder, attachments, std::vector<int>{});
+}
+
+// the contracted cycle is added before the segment edges: the cycle search of the
+// recursion then starts walking along it, which keeps the recursion shallower
+void SegmentsHandler::addContractedCycle(GraphBuilder& builder, int numberOfAttachments) {
+    if (numberOfAttachments == 2) {
+        int firstDummy = builder.size();
+        builder.addNodes(2);
+        builder.addEdge(0, firstDummy);
+        builder.addEdge(firstDummy, 1);
+        builder.addEdge(1, firstDummy+1);
+        builder.addEdge(firstDummy+1, 0);
+        return;
+    }
+    for (int i = 0; i < numberOfAttachments-1; ++i)
+        builder.addEdge(i, i+1);
+    builder.addEdge(0, numberOfAttachments-1);
+}
+
+// builds the segment directly inside segments_m
+void SegmentsHandler::addSegment(GraphBuilder& builder, std::vector<int>& attachments, const std::vector<int>& nodes) {
+    int numberOfAttachments = attachments.size();
+    segments_m.emplace_back(builder, originalComponent_m, originalCycle_m, std::move(attachments), nodes.size());
+    Segment& segment = segments_m.back();
+    for (int i = 0; i < numberOfAttachments; ++i)
+        segment.assignNodeLabel(i, originalCycle_m.nodes()[segment.getAttachments()[i]]);
+    for (int i = 0; i < nodes.size(); ++i)
+        segment.assignNodeLabel(i+numberOfAttachments, nodes[i]);
 }
 
-const std::vector<Segment> SegmentsHandler::getSegments() {
+const std::vector<Segment>& SegmentsHandler::getSegments() const {
     return segments_m;
+}
+
+bool SegmentsHandler::isCycleBad() const {
+    return isCycleBad_m;
+}
+
+const std::vector<int>& SegmentsHandler::getBadSegmentNodes() const {
+    assert(isCycleBad_m);
+    return badSegmentNodes_m;
+}
+
+const std::vector<int>& SegmentsHandler::getBadSegmentAttachments() const {
+    assert(isCycleBad_m);
+    return badSegmentAttachments_m;
+}
+
+// bfs from start, a node is reached when it is marked and then its prev is valid
+std::vector<int> SegmentsHandler::computePathBetweenAttachments(int start, int end) const {
+    assert(isCycleBad_m);
+    int from = originalCycle_m.nodes()[badSegmentAttachments_m[start]];
+    int to = originalCycle_m.nodes()[badSegmentAttachments_m[end]];
+    workspace_m.reserveNodes(originalComponent_m.size());
+    std::vector<int>& prevOfNode = workspace_m.nodeMap;
+    EpochMarker& isNodeReached = workspace_m.visited;
+    isNodeReached.reset(originalComponent_m.size());
+    isNodeReached.mark(from);
+    std::vector<int>& queue = workspace_m.queue;
+    queue.clear();
+    queue.push_back(from);
+    for (int head = 0; head < queue.size(); ++head) {
+        int node = queue[head];
+        // the path must not go through other cycle nodes
+        if (node != from && originalCycle_m.hasNode(node))
+            continue;
+        for (const int neighbor : originalComponent_m.getNeighborsOfNode(node)) {
+            // edges of the cycle (there are no chords)
+            if (node == from && originalCycle_m.hasNode(neighbor))
+                continue;
+            if (!isNodeReached.isMarked(neighbor)) {
+                isNodeReached.mark(neighbor);
+                prevOfNode[neighbor] = node;
+                queue.push_back(neighbor);
+                if (neighbor == to) break;
+            }
+        }
+        if (isNodeReached.isMarked(to)) break;
+    }
+    std::vector<int> path{};
+    for (int crawl = to; crawl != from; crawl = prevOfNode[crawl])
+        path.push_back(crawl);
+    path.push_back(from);
+    std::reverse(path.begin(), path.end());
+    return path;
 }
\ No newline at end of file
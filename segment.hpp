@@ -3,24 +3,33 @@
 
 #include <vector>
 #include <utility>
-#include <list>
 
 #include "cycle.hpp"
 #include "biconnectedComponent.hpp"
 
+// segment that does not copy the cycle: it stores the attachments (as positions in the
+// shared cycle), the segment own nodes and edges, and the cycle with each arc between two
+// consecutive attachments contracted to a single edge (with only 2 attachments each arc
+// keeps a dummy node, so that the graph stays simple)
+// nodes: the attachments in cycle order, then the own nodes, then the dummy nodes
 class Segment : public Component {
 private:
-    std::vector<int> attachmentNodes_m{};
-    std::vector<bool> isNodeAnAttachment_m{};
+    std::vector<int> attachments_m{}; // positions in the cycle, increasing
+    int numberOfOwnNodes_m{};
     const Component& originalComponent_m;
     const Cycle& originalCycle_m;
 public:
-    Segment(int numberOfNodes, const Component& originalComponent, const Cycle& cycle);
+    Segment(const GraphBuilder& builder, const Component& originalComponent, const Cycle& cycle,
+        std::vector<int> attachments, int numberOfOwnNodes);
     bool isPath() const;
+    // a single edge between two cycle nodes
+    bool isChord() const;
     const std::vector<int>& getAttachments() const;
-    void addAttachment(int attachment);
     bool isNodeAnAttachment(int node) const;
-    std::list<int> computePathBetweenAttachments(int start, int end) const;
+    bool isNodeADummy(int node) const;
+    int getAttachmentOfCycleNode(int cycleNode) const;
+    int getNextOfAttachment(int attachment) const;
+    int getPrevOfAttachment(int attachment) const;
     const Cycle& getOriginalCycle() const;
     const Component& getOriginalComponent() const;
 };
@@ -30,14 +39,41 @@ private:
     std::vector<Segment> segments_m{};
     const Cycle& originalCycle_m;
     const Component& originalComponent_m;
-    Segment buildSegment(std::vector<int>& nodes, std::vector<std::pair<int, int>>& edges);
-    Segment buildChord(int attachment1, int attachment2);
-    void dfsFindSegments(int node, bool isNodeVisited[], std::vector<int>& nodesInSegment, std::vector<std::pair<int, int>>& edgesInSegment);
+    EmbedderWorkspace& workspace_m;
+    // a single segment that is not a path is not built: only its nodes and attachments are kept
+    bool isCycleBad_m{false};
+    std::vector<int> badSegmentNodes_m{};
+    std::vector<int> badSegmentAttachments_m{};
+    bool isOnlySegment(const std::vector<int>& nodes, const std::vector<std::pair<int, int>>& edges) const;
+    bool isPath(const std::vector<int>& nodes) const;
+    std::vector<int> computeAttachments(const std::vector<std::pair<int, int>>& edges) const;
+    void buildSegment(const std::vector<int>& nodes, const std::vector<std::pair<int, int>>& edges);
+    void buildChord(int attachment1, int attachment2);
+    void addContractedCycle(GraphBuilder& builder, int numberOfAttachments);
+    void addSegment(GraphBuilder& builder, std::vector<int>& attachments, const std::vector<int>& nodes);
+    void dfsFindSegments(int node, std::vector<int>& nodesInSegment, std::vector<std::pair<int, int>>& edgesInSegment);
+    void findSegmentOfNode(int node);
     void findSegments();
+    void findChordsOfNode(int node);
     void findChords();
 public:
-    SegmentsHandler(const Component& component, const Cycle& cycle);
-    const std::vector<Segment> getSegments();
+    SegmentsHandler(const Component& component, const Cycle& cycle, EmbedderWorkspace& workspace);
+    // segments of cycle visiting only nodes (without repetitions), which must contain every node
+    // not in cycle and every node of cycle with a neighbor other than its two cycle neighbors:
+    // the same segments as with the other constructor, in the order of nodes
+    SegmentsHandler(const Component& component, const Cycle& cycle, const std::vector<int>& nodes,
+        EmbedderWorkspace& workspace);
+    const std::vector<Segment>& getSegments() const;
+    // the cycle has a single segment, which is not a path: then there are no segments, the
+    // cycle has to be changed (see Embedder::makeCycleGood)
+    bool isCycleBad() const;
+    // nodes of the segment of a bad cycle, not in the cycle
+    const std::vector<int>& getBadSegmentNodes() const;
+    // attachments of the segment of a bad cycle, as positions in the cycle, increasing
+    const std::vector<int>& getBadSegmentAttachments() const;
+    // shortest path (as labels of the component) between two attachments of the segment of
+    // a bad cycle, given as indexes in getBadSegmentAttachments, through the segment nodes
+    std::vector<int> computePathBetweenAttachments(int start, int end) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "seriesReduction.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+#include "embedder.hpp"
+
+SeriesReduction::SeriesReduction(const MyGraph& graph) : graph_m(graph) {
+    std::vector<bool> isKept(graph.size());
+    for (int node = 0; node < graph.size(); ++node)
+        isKept[node] = graph.getNeighborsOfNode(node).size() != 2;
+    std::vector<bool> isInner(graph.size(), false);
+    std::vector<int> nodes{};
+    pathOffsets_m.push_back(0);
+    for (int node = 0; node < graph.size(); ++node) {
+        if (!isKept[node]) continue;
+        for (int neighbor : graph.getNeighborsOfNode(node)) {
+            if (isKept[neighbor]) {
+                if (node < neighbor) addPath({node, neighbor});
+                continue;
+            }
+            if (isInner[neighbor]) continue; // path already walked from its other end
+            nodes.clear();
+            nodes.push_back(node);
+            int prev = node;
+            int current = neighbor;
+            while (!isKept[current]) {
+                isInner[current] = true;
+                nodes.push_back(current);
+                std::span<const int> neighbors = graph.getNeighborsOfNode(current);
+                int next = neighbors[0] == prev ? neighbors[1] : neighbors[0];
+                prev = current;
+                current = next;
+            }
+            nodes.push_back(current);
+            addPath(nodes);
+        }
+    }
+    // nodes of degree 2 that no path reached are on components that are just a cycle
+    for (int node = 0; node < graph.size(); ++node)
+        if (!isKept[node] && !isInner[node]) isKept[node] = true;
+    for (int node = 0; node < graph.size(); ++node) {
+        if (isInner[node] || graph.getNeighborsOfNode(node).size() != 2) continue;
+        for (int neighbor : graph.getNeighborsOfNode(node))
+            if (node < neighbor) addPath({node, neighbor});
+    }
+    reducedNode_m.resize(graph.size(), -1);
+    for (int node = 0; node < graph.size(); ++node) {
+        if (!isKept[node]) continue;
+        reducedNode_m[node] = originalNode_m.size();
+        originalNode_m.push_back(node);
+    }
+    groupPaths();
+    // reduced neighbors follow the order of the paths leaving the node (the embedder
+    // is sensitive to the order of the neighbors, this keeps the order of the graph)
+    GraphBuilder builder(originalNode_m.size());
+    builder.reserve(2*groupEnds_m.size());
+    std::vector<int> lastAddedBy(originalNode_m.size(), -1);
+    for (int reducedNode = 0; reducedNode < originalNode_m.size(); ++reducedNode) {
+        int node = originalNode_m[reducedNode];
+        for (int neighbor : graph.getNeighborsOfNode(node)) {
+            int reducedNeighbor = reducedNode_m[findEndOfPath(node, neighbor)];
+            if (reducedNeighbor == reducedNode || lastAddedBy[reducedNeighbor] == reducedNode) continue;
+            lastAddedBy[reducedNeighbor] = reducedNode;
+            builder.addSingleEdge(reducedNode, reducedNeighbor);
+        }
+    }
+    reducedGraph_m.emplace(builder);
+}
+
+// other end of the path that starts from node going to neighbor
+int SeriesReduction::findEndOfPath(int node, int neighbor) const {
+    int prev = node;
+    int current = neighbor;
+    while (reducedNode_m[current] == -1) {
+        std::span<const int> neighbors = graph_m.getNeighborsOfNode(current);
+        int next = neighbors[0] == prev ? neighbors[1] : neighbors[0];
+        prev = current;
+        current = next;
+    }
+    return current;
+}
+
+bool SeriesReduction::hasNodesOfDegreeTwo(const MyGraph& graph) {
+    for (int node = 0; node < graph.size(); ++node)
+        if (graph.getNeighborsOfNode(node).size() == 2) return true;
+    return false;
+}
+
+void SeriesReduction::addPath(const std::vector<int>& nodes) {
+    pathNodes_m.insert(pathNodes_m.end(), nodes.begin(), nodes.end());
+    pathOffsets_m.push_back(pathNodes_m.size());
+}
+
+// orients every path from its end with the smaller reduced index,
+// then sorts the paths by their ends: paths with the same ends become a single reduced edge
+void SeriesReduction::groupPaths() {
+    int numberOfPaths = pathOffsets_m.size()-1;
+    std::vector<int> paths{};
+    for (int path = 0; path < numberOfPaths; ++path) {
+        auto begin = pathNodes_m.begin()+pathOffsets_m[path];
+        auto end = pathNodes_m.begin()+pathOffsets_m[path+1];
+        int from = reducedNode_m[*begin];
+        int to = reducedNode_m[*(end-1)];
+        assert(from != -1 && to != -1);
+        if (from == to) {
+            loops_m.push_back(path);
+            continue;
+        }
+        if (from > to) std::reverse(begin, end);
+        paths.push_back(path);
+    }
+    auto endsOfPath = [&](int path) {
+        int from = reducedNode_m[pathNodes_m[pathOffsets_m[path]]];
+        int to = reducedNode_m[pathNodes_m[pathOffsets_m[path+1]-1]];
+        return std::make_pair(from, to);
+    };
+    std::stable_sort(paths.begin(), paths.end(), [&](int a, int b) {
+        return endsOfPath(a) < endsOfPath(b);
+    });
+    pathOrder_m = paths;
+    for (int i = 0; i < pathOrder_m.size(); ++i) {
+        std::pair<int, int> ends = endsOfPath(pathOrder_m[i]);
+        if (groupEnds_m.empty() || groupEnds_m.back() != ends) {
+            groupEnds_m.push_back(ends);
+            groupOffsets_m.push_back(i);
+        }
+    }
+    groupOffsets_m.push_back(pathOrder_m.size());
+}
+
+int SeriesReduction::findGroup(int from, int to) const {
+    auto it = std::lower_bound(groupEnds_m.begin(), groupEnds_m.end(), std::make_pair(from, to));
+    assert(it != groupEnds_m.end() && *it == std::make_pair(from, to));
+    return it-groupEnds_m.begin();
+}
+
+const MyGraph& SeriesReduction::getReducedGraph() const {
+    return reducedGraph_m.value();
+}
+
+// each reduced edge is replaced, around both of its ends, by its paths side by side:
+// in path order around the smaller end and in reverse order around the other one,
+// so that consecutive paths bound a face; a path from a node back to itself is
+// inserted around its node as two consecutive edges
+Embedding SeriesReduction::expand(const Embedding& reducedEmbedding) const {
+    assert(reducedEmbedding.size() == originalNode_m.size());
+    GraphBuilder output(graph_m.size());
+    output.reserve(2*graph_m.numberOfEdges());
+    for (int reducedNode = 0; reducedNode < reducedEmbedding.size(); ++reducedNode) {
+        int node = originalNode_m[reducedNode];
+        for (int reducedNeighbor : reducedEmbedding.getNeighborsOfNode(reducedNode)) {
+            bool isSmallerEnd = reducedNode < reducedNeighbor;
+            int group = findGroup(std::min(reducedNode, reducedNeighbor), std::max(reducedNode, reducedNeighbor));
+            int begin = groupOffsets_m[group];
+            int end = groupOffsets_m[group+1];
+            for (int i = 0; i < end-begin; ++i) {
+                int path = isSmallerEnd ? pathOrder_m[begin+i] : pathOrder_m[end-1-i];
+                int neighbor = isSmallerEnd ? pathNodes_m[pathOffsets_m[path]+1] : pathNodes_m[pathOffsets_m[path+1]-2];
+                output.addSingleEdge(node, neighbor);
+            }
+        }
+    }
+    for (int path : loops_m) {
+        int node = pathNodes_m[pathOffsets_m[path]];
+        output.addSingleEdge(node, pathNodes_m[pathOffsets_m[path]+1]);
+        output.addSingleEdge(node, pathNodes_m[pathOffsets_m[path+1]-2]);
+    }
+    for (int path = 0; path+1 < pathOffsets_m.size(); ++path) {
+        for (int i = pathOffsets_m[path]+1; i < pathOffsets_m[path+1]-1; ++i) {
+            output.addSingleEdge(pathNodes_m[i], pathNodes_m[i-1]);
+            output.addSingleEdge(pathNodes_m[i], pathNodes_m[i+1]);
+        }
+    }
+    return Embedding(output);
+}
+
+// paths with the same ends are interchangeable, the first one is taken
+void SeriesReduction::expandEdges(std::vector<std::pair<int, int>>& edges) const {
+    std::vector<std::pair<int, int>> expanded{};
+    for (const auto& [from, to] : edges) {
+        int path = pathOrder_m[groupOffsets_m[findGroup(std::min(from, to), std::max(from, to))]];
+        for (int i = pathOffsets_m[path]; i+1 < pathOffsets_m[path+1]; ++i)
+            expanded.push_back(std::make_pair(pathNodes_m[i], pathNodes_m[i+1]));
+    }
+    edges = std::move(expanded);
+}
\ No newline at end of file
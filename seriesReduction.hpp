@@ -0,0 +1,50 @@
+#ifndef MY_SERIES_REDUCTION_H
+#define MY_SERIES_REDUCTION_H
+
+#include <vector>
+#include <optional>
+#include <utility>
+
+#include "graph.hpp"
+
+class Embedding;
+
+// replaces every maximal path whose inner nodes have degree 2 with a single edge:
+// paths with the same ends keep a single edge (parallel edges do not change planarity)
+// and paths that go back to where they started are dropped (same for self loops),
+// the embedding of the reduced graph is then expanded back into an embedding of the graph
+// (components that are just a cycle are kept as they are)
+class SeriesReduction {
+private:
+    const MyGraph& graph_m;
+    std::vector<int> reducedNode_m{}; // -1 for inner nodes of paths
+    std::vector<int> originalNode_m{};
+    // nodes of each path, ends included, from the end with the smaller reduced index
+    std::vector<int> pathNodes_m{};
+    std::vector<int> pathOffsets_m{};
+    // paths sorted by their ends: the paths of reduced edge i are
+    // pathOrder_m[groupOffsets_m[i]] ... pathOrder_m[groupOffsets_m[i+1]-1]
+    std::vector<std::pair<int, int>> groupEnds_m{};
+    std::vector<int> groupOffsets_m{};
+    std::vector<int> pathOrder_m{};
+    // paths from a node back to itself
+    std::vector<int> loops_m{};
+    std::optional<MyGraph> reducedGraph_m{};
+
+    void addPath(const std::vector<int>& nodes);
+    void groupPaths();
+    int findGroup(int from, int to) const;
+    int findEndOfPath(int node, int neighbor) const;
+
+public:
+    SeriesReduction(const MyGraph& graph);
+
+    // without nodes of degree 2 the reduced graph would be the graph itself
+    static bool hasNodesOfDegreeTwo(const MyGraph& graph);
+    const MyGraph& getReducedGraph() const;
+    Embedding expand(const Embedding& reducedEmbedding) const;
+    // replaces each edge of the reduced graph with the edges of one of its paths
+    void expandEdges(std::vector<std::pair<int, int>>& edges) const;
+};
+
+#endif
\ No newline at end of file
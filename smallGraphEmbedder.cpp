@@ -0,0 +1,309 @@
+#include "smallGraphEmbedder.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace {
+    uint64_t bit(int node) {
+        return uint64_t(1) << node;
+    }
+
+    int lowestNode(uint64_t mask) {
+        return std::countr_zero(mask);
+    }
+
+    // nodes above node
+    uint64_t nodesAfter(int node) {
+        return ~((bit(node) << 1)-1);
+    }
+}
+
+std::optional<Embedding> SmallGraphEmbedder::embed(const MyGraph& graph) {
+    assert(graph.size() <= maxNodes);
+    numberOfNodes_m = graph.size();
+    for (int node = 0; node < numberOfNodes_m; ++node) {
+        adjacency_m[node] = 0;
+        embedded_m[node] = 0;
+        for (int neighbor : graph.getNeighborsOfNode(node))
+            adjacency_m[node] |= bit(neighbor);
+    }
+    findBlocks();
+    for (int i = 0; i < numberOfBlocks_m; ++i)
+        if (!embedBlock(blocks_m[i])) return std::nullopt;
+    // the rotation of a cut node is its rotation in each of its blocks, one after the other
+    GraphBuilder builder(numberOfNodes_m);
+    builder.reserve(graph.getNeighbors().size());
+    for (int node = 0; node < numberOfNodes_m; ++node) {
+        for (int i = 0; i < numberOfBlocks_m; ++i) {
+            if ((blocks_m[i] & bit(node)) == 0) continue;
+            assert((adjacency_m[node] & blocks_m[i]) != 0);
+            int first = lowestNode(adjacency_m[node] & blocks_m[i]);
+            int neighbor = first;
+            do {
+                builder.addSingleEdge(node, neighbor);
+                neighbor = next_m[node][neighbor];
+            } while (neighbor != first);
+        }
+    }
+    return Embedding(builder);
+}
+
+// Tarjan's depth first search, the neighbors left to explore of each node being a mask
+void SmallGraphEmbedder::findBlocks() {
+    int order[maxNodes];
+    int low[maxNodes];
+    uint64_t unexplored[maxNodes];
+    uint8_t dfsStack[maxNodes];
+    uint8_t nodeStack[maxNodes];
+    std::fill(order, order+numberOfNodes_m, -1);
+    numberOfBlocks_m = 0;
+    int time = 0;
+    for (int root = 0; root < numberOfNodes_m; ++root) {
+        if (order[root] != -1) continue;
+        order[root] = low[root] = time++;
+        unexplored[root] = adjacency_m[root];
+        parent_m[root] = root;
+        int dfsSize = 0;
+        int nodeStackSize = 0;
+        dfsStack[dfsSize++] = root;
+        nodeStack[nodeStackSize++] = root;
+        while (dfsSize > 0) {
+            int node = dfsStack[dfsSize-1];
+            if (unexplored[node] != 0) {
+                int neighbor = lowestNode(unexplored[node]);
+                unexplored[node] &= unexplored[node]-1;
+                if (order[neighbor] == -1) {
+                    order[neighbor] = low[neighbor] = time++;
+                    unexplored[neighbor] = adjacency_m[neighbor];
+                    parent_m[neighbor] = node;
+                    dfsStack[dfsSize++] = neighbor;
+                    nodeStack[nodeStackSize++] = neighbor;
+                }
+                else if (neighbor != parent_m[node])
+                    low[node] = std::min(low[node], order[neighbor]);
+                continue;
+            }
+            if (--dfsSize == 0) break;
+            int parent = dfsStack[dfsSize-1];
+            low[parent] = std::min(low[parent], low[node]);
+            if (low[node] < order[parent]) continue;
+            // parent separates the nodes above node in the stack from the rest
+            uint64_t block = bit(parent);
+            int top;
+            do {
+                top = nodeStack[--nodeStackSize];
+                block |= bit(top);
+            } while (top != node);
+            blocks_m[numberOfBlocks_m++] = block;
+        }
+    }
+}
+
+// path addition on a biconnected block: false if it is not planar
+bool SmallGraphEmbedder::embedBlock(uint64_t block) {
+    int size = std::popcount(block);
+    if (size == 2) {
+        int from = lowestNode(block);
+        int to = lowestNode(block & ~bit(from));
+        next_m[from][to] = to;
+        next_m[to][from] = from;
+        return true;
+    }
+    int numberOfHalfEdges = 0;
+    for (uint64_t nodes = block; nodes != 0; nodes &= nodes-1)
+        numberOfHalfEdges += std::popcount(adjacency_m[lowestNode(nodes)] & block);
+    if (numberOfHalfEdges/2 > 3*size-6) return false;
+    // a cycle and its two faces
+    int length = findCycle(block);
+    uint64_t done = 0;
+    for (int i = 0; i < length; ++i) {
+        int node = path_m[i];
+        int prev = path_m[(i+length-1) % length];
+        int next = path_m[(i+1) % length];
+        next_m[node][prev] = next;
+        next_m[node][next] = prev;
+        embedded_m[node] = bit(prev) | bit(next);
+        done |= bit(node);
+        faceNodes_m[0][i] = node;
+        faceNodes_m[1][i] = path_m[length-1-i];
+    }
+    faceSize_m[0] = faceSize_m[1] = length;
+    faceMask_m[0] = faceMask_m[1] = done;
+    numberOfFaces_m = 2;
+    while (true) {
+        // the fragment with the fewest admissible faces, the first one with at most one
+        int bestCount = maxFaces+1;
+        int bestFace = -1;
+        int bestFrom = -1;
+        int bestTo = -1;
+        uint64_t bestThrough = 0;
+        auto consider = [&](uint64_t attachments, int from, int to, uint64_t through) {
+            int count = 0;
+            int face = -1;
+            for (int f = 0; f < numberOfFaces_m; ++f) {
+                if ((faceMask_m[f] & attachments) != attachments) continue;
+                if (count++ == 0) face = f;
+                if (count >= bestCount) return false;
+            }
+            bestCount = count;
+            bestFace = face;
+            bestFrom = from;
+            bestTo = to;
+            bestThrough = through;
+            return count <= 1;
+        };
+        bool isChosen = false;
+        for (uint64_t nodes = done; nodes != 0 && !isChosen; nodes &= nodes-1) {
+            int from = lowestNode(nodes);
+            uint64_t chords = adjacency_m[from] & done & ~embedded_m[from] & nodesAfter(from);
+            for (; chords != 0 && !isChosen; chords &= chords-1) {
+                int to = lowestNode(chords);
+                isChosen = consider(bit(from) | bit(to), from, to, 0);
+            }
+        }
+        for (uint64_t remaining = block & ~done; remaining != 0 && !isChosen; ) {
+            assert(remaining != 0);
+            uint64_t component = bit(lowestNode(remaining));
+            uint64_t neighbors = 0;
+            for (uint64_t frontier = component; frontier != 0; ) {
+                uint64_t reached = 0;
+                for (; frontier != 0; frontier &= frontier-1)
+                    reached |= adjacency_m[lowestNode(frontier)];
+                neighbors |= reached;
+                frontier = reached & remaining & ~component;
+                component |= frontier;
+            }
+            remaining &= ~component;
+            uint64_t attachments = neighbors & done;
+            assert(std::popcount(attachments) >= 2);
+            int from = lowestNode(attachments);
+            isChosen = consider(attachments, from, lowestNode(attachments & ~bit(from)), component);
+        }
+        if (bestCount == maxFaces+1) return true; // every edge is embedded
+        if (bestCount == 0) return false;
+        if (bestThrough == 0) {
+            path_m[0] = bestFrom;
+            path_m[1] = bestTo;
+            length = 2;
+        }
+        else length = findPath(bestFrom, bestTo, bestThrough);
+        addPath(length, bestFace);
+        for (int i = 1; i < length-1; ++i)
+            done |= bit(path_m[i]);
+    }
+}
+
+// breadth first search from a neighbor of the first node of block back to it, not through
+// the edge between them: the cycle is left in path_m, its length is returned
+int SmallGraphEmbedder::findCycle(uint64_t block) {
+    assert(block != 0);
+    int root = lowestNode(block);
+    assert((adjacency_m[root] & block) != 0);
+    int first = lowestNode(adjacency_m[root] & block);
+    uint64_t visited = bit(root) | bit(first);
+    uint64_t frontier = bit(first);
+    int last = -1;
+    while (last == -1) {
+        assert(frontier != 0);
+        uint64_t reached = 0;
+        for (; frontier != 0 && last == -1; frontier &= frontier-1) {
+            int node = lowestNode(frontier);
+            if (node != first && (adjacency_m[node] & bit(root)) != 0) last = node;
+            uint64_t newNodes = adjacency_m[node] & block & ~visited & ~reached;
+            for (uint64_t nodes = newNodes; nodes != 0; nodes &= nodes-1)
+                parent_m[lowestNode(nodes)] = node;
+            reached |= newNodes;
+        }
+        visited |= reached;
+        frontier = reached;
+    }
+    int length = 0;
+    for (int node = last; node != first; node = parent_m[node])
+        path_m[length++] = node;
+    path_m[length++] = first;
+    path_m[length++] = root;
+    return length;
+}
+
+// breadth first search from node from to node to with all the nodes in between in through:
+// the path is left in path_m, its length is returned
+int SmallGraphEmbedder::findPath(int from, int to, uint64_t through) {
+    uint64_t frontier = adjacency_m[from] & through;
+    uint64_t visited = frontier;
+    for (uint64_t nodes = frontier; nodes != 0; nodes &= nodes-1)
+        parent_m[lowestNode(nodes)] = from;
+    int last = -1;
+    while (last == -1) {
+        assert(frontier != 0);
+        uint64_t reached = 0;
+        for (; frontier != 0 && last == -1; frontier &= frontier-1) {
+            int node = lowestNode(frontier);
+            if ((adjacency_m[node] & bit(to)) != 0) last = node;
+            uint64_t newNodes = adjacency_m[node] & through & ~visited & ~reached;
+            for (uint64_t nodes = newNodes; nodes != 0; nodes &= nodes-1)
+                parent_m[lowestNode(nodes)] = node;
+            reached |= newNodes;
+        }
+        visited |= reached;
+        frontier = reached;
+    }
+    int length = 0;
+    for (int node = last; node != from; node = parent_m[node])
+        path_m[length++] = node;
+    path_m[length++] = from;
+    std::reverse(path_m, path_m+length);
+    path_m[length++] = to;
+    return length;
+}
+
+// the path in path_m (between two nodes of face, through nodes not embedded yet) splits face:
+// face becomes the path followed by the face from its last node back to its first one,
+// the new face is the reversed path followed by the face from its first node to its last one
+void SmallGraphEmbedder::addPath(int length, int face) {
+    int from = path_m[0];
+    int to = path_m[length-1];
+    int size = faceSize_m[face];
+    uint8_t nodes[maxNodes];
+    std::copy(faceNodes_m[face], faceNodes_m[face]+size, nodes);
+    int fromIndex = std::find(nodes, nodes+size, from)-nodes;
+    int toIndex = std::find(nodes, nodes+size, to)-nodes;
+    assert(fromIndex < size && toIndex < size);
+    // the path goes in the angle of face at its ends, after the node before them on the face
+    int beforeFrom = nodes[(fromIndex+size-1) % size];
+    int beforeTo = nodes[(toIndex+size-1) % size];
+    int second = path_m[1];
+    int secondToLast = path_m[length-2];
+    next_m[from][second] = next_m[from][beforeFrom];
+    next_m[from][beforeFrom] = second;
+    embedded_m[from] |= bit(second);
+    next_m[to][secondToLast] = next_m[to][beforeTo];
+    next_m[to][beforeTo] = secondToLast;
+    embedded_m[to] |= bit(secondToLast);
+    for (int i = 1; i < length-1; ++i) {
+        int node = path_m[i];
+        next_m[node][path_m[i-1]] = path_m[i+1];
+        next_m[node][path_m[i+1]] = path_m[i-1];
+        embedded_m[node] = bit(path_m[i-1]) | bit(path_m[i+1]);
+    }
+    int newFace = numberOfFaces_m++;
+    assert(newFace < maxFaces);
+    int faceLength = 0;
+    int newFaceLength = 0;
+    for (int i = 0; i < length; ++i) {
+        faceNodes_m[face][faceLength++] = path_m[i];
+        faceNodes_m[newFace][newFaceLength++] = path_m[length-1-i];
+    }
+    for (int i = (toIndex+1) % size; i != fromIndex; i = (i+1) % size)
+        faceNodes_m[face][faceLength++] = nodes[i];
+    for (int i = (fromIndex+1) % size; i != toIndex; i = (i+1) % size)
+        faceNodes_m[newFace][newFaceLength++] = nodes[i];
+    faceSize_m[face] = faceLength;
+    faceSize_m[newFace] = newFaceLength;
+    faceMask_m[face] = 0;
+    faceMask_m[newFace] = 0;
+    for (int i = 0; i < faceLength; ++i)
+        faceMask_m[face] |= bit(faceNodes_m[face][i]);
+    for (int i = 0; i < newFaceLength; ++i)
+        faceMask_m[newFace] |= bit(faceNodes_m[newFace][i]);
+}
\ No newline at end of file
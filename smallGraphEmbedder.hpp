@@ -0,0 +1,58 @@
+#ifndef MY_SMALL_GRAPH_EMBEDDER_H
+#define MY_SMALL_GRAPH_EMBEDDER_H
+
+#include <cstdint>
+#include <optional>
+
+#include "graph.hpp"
+#include "embedder.hpp"
+
+// planarity test and embedding of graphs with at most 64 nodes, with the neighbors of each
+// node as a 64 bit mask and fixed size arrays, so nothing is allocated but the result.
+// the blocks are found by a depth first search over the masks, then each block is embedded
+// by path addition as Demoucron, Malgrange and Pertuiset: starting from a cycle, the fragments
+// not embedded yet (chords, and connected components of the nodes not embedded with their
+// attachments) are found by flooding masks, a face is admissible for a fragment if the mask of
+// its nodes covers the attachments, and a path of a fragment with the fewest admissible faces
+// is added to one of them (none proves the block non planar). blocks are glued at their cut nodes.
+// gives the same verdict as Embedder, not necessarily the same rotations
+class SmallGraphEmbedder {
+public:
+    static constexpr int maxNodes = 64;
+
+private:
+    // at most 2n-4 faces for a block of n nodes
+    static constexpr int maxFaces = 2*maxNodes;
+
+    int numberOfNodes_m{0};
+    uint64_t adjacency_m[maxNodes]{};
+    // edges embedded so far
+    uint64_t embedded_m[maxNodes]{};
+    // rotations: next_m[v][u] is the neighbor after u around v, for the embedded edges;
+    // the face after the dart u->v continues with v->next_m[v][u]
+    uint8_t next_m[maxNodes][maxNodes]{};
+    // nodes of each block
+    uint64_t blocks_m[maxNodes]{};
+    int numberOfBlocks_m{0};
+    // faces of the block being embedded (simple cycles, as the block is biconnected):
+    // faceNodes_m[f][i+1] follows faceNodes_m[f][i] on face f
+    uint8_t faceNodes_m[maxFaces][maxNodes]{};
+    int faceSize_m[maxFaces]{};
+    uint64_t faceMask_m[maxFaces]{};
+    int numberOfFaces_m{0};
+    // scratch
+    uint8_t path_m[maxNodes]{};
+    uint8_t parent_m[maxNodes]{};
+
+    void findBlocks();
+    bool embedBlock(uint64_t block);
+    int findCycle(uint64_t block);
+    int findPath(int from, int to, uint64_t through);
+    void addPath(int length, int face);
+
+public:
+    // graph must be simple with at most maxNodes nodes
+    std::optional<Embedding> embed(const MyGraph& graph);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "threadPool.hpp"
+
+#include <cassert>
+#include <thread>
+#include <algorithm>
+#include <utility>
+#include <system_error>
+#include <sys/resource.h>
+
+namespace {
+    thread_local const ThreadPool* currentThreadPool = nullptr;
+    thread_local int currentThreadWorker = -1;
+
+    // the embedder recursion can be deep: workers get the stack the main thread would get
+    // (1 GB if unlimited, it is only reserved address space until used)
+    size_t workerStackSize() {
+        rlimit limit;
+        if (getrlimit(RLIMIT_STACK, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY)
+            return size_t(1) << 30;
+        return std::max<size_t>(limit.rlim_cur, size_t(8) << 20);
+    }
+
+    struct WorkerStart {
+        ThreadPool* threadPool;
+        int worker;
+    };
+}
+
+// a worker that cannot be started with the large stack is retried with the default one, the
+// pool keeps the workers it could start; the workers wait for the constructor (mutex_m) so
+// that they see the final number of queues
+ThreadPool::ThreadPool(int numberOfThreads) {
+    assert(numberOfThreads > 0);
+    for (int queue = 0; queue <= numberOfThreads; ++queue)
+        queues_m.push_back(std::make_unique<TaskQueue>());
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, workerStackSize());
+    threads_m.resize(numberOfThreads);
+    std::lock_guard<std::mutex> lock(mutex_m);
+    int numberOfStarted = 0;
+    int error = 0;
+    for (; numberOfStarted < numberOfThreads; ++numberOfStarted) {
+        WorkerStart* start = new WorkerStart{this, numberOfStarted};
+        pthread_t& thread = threads_m[numberOfStarted];
+        error = pthread_create(&thread, &attributes, &ThreadPool::startWorker, start);
+        if (error != 0) error = pthread_create(&thread, nullptr, &ThreadPool::startWorker, start);
+        if (error != 0) {
+            delete start;
+            break;
+        }
+    }
+    pthread_attr_destroy(&attributes);
+    if (numberOfStarted == 0) throw std::system_error(error, std::generic_category(), "pthread_create");
+    threads_m.resize(numberOfStarted);
+    queues_m.erase(queues_m.begin()+numberOfStarted, queues_m.end()-1);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_m);
+        isStopping_m = true;
+    }
+    taskAvailable_m.notify_all();
+    for (pthread_t& thread : threads_m)
+        pthread_join(thread, nullptr);
+}
+
+void* ThreadPool::startWorker(void* argument) {
+    WorkerStart* start = static_cast<WorkerStart*>(argument);
+    ThreadPool* threadPool = start->threadPool;
+    int worker = start->worker;
+    delete start;
+    {
+        // wait for the constructor
+        std::lock_guard<std::mutex> lock(threadPool->mutex_m);
+    }
+    currentThreadPool = threadPool;
+    currentThreadWorker = worker;
+    threadPool->workerLoop(worker);
+    return nullptr;
+}
+
+void ThreadPool::workerLoop(int worker) {
+    while (true) {
+        if (runPendingTask(worker)) continue;
+        std::unique_lock<std::mutex> lock(mutex_m);
+        taskAvailable_m.wait(lock, [this] { return isStopping_m || queuedTasks_m.load() > 0; });
+        if (isStopping_m && queuedTasks_m.load() == 0) return;
+    }
+}
+
+bool ThreadPool::popTask(int queue, bool isNewest, Task& task) {
+    TaskQueue& taskQueue = *queues_m[queue];
+    std::lock_guard<std::mutex> lock(taskQueue.mutex);
+    if (taskQueue.tasks.empty()) return false;
+    if (isNewest) {
+        task = std::move(taskQueue.tasks.back());
+        taskQueue.tasks.pop_back();
+    }
+    else {
+        task = std::move(taskQueue.tasks.front());
+        taskQueue.tasks.pop_front();
+    }
+    --queuedTasks_m;
+    return true;
+}
+
+void ThreadPool::finishTask() {
+    std::lock_guard<std::mutex> lock(mutex_m);
+    if (--unfinishedTasks_m == 0)
+        allTasksDone_m.notify_all();
+}
+
+// own queue (newest task), then the other workers (oldest task), then the shared queue
+bool ThreadPool::runPendingTask(int worker) {
+    assert(worker >= 0 && worker < size());
+    Task task;
+    bool found = popTask(worker, true, task);
+    for (int i = 1; i <= size() && !found; ++i)
+        found = popTask((worker+i) % (size()+1), false, task);
+    if (!found) return false;
+    task(worker);
+    finishTask();
+    return true;
+}
+
+void ThreadPool::submit(Task task) {
+    int worker = currentWorker();
+    int queue = worker == -1 ? size() : worker;
+    {
+        std::lock_guard<std::mutex> lock(queues_m[queue]->mutex);
+        queues_m[queue]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_m);
+        ++unfinishedTasks_m;
+        ++queuedTasks_m;
+    }
+    taskAvailable_m.notify_one();
+}
+
+void ThreadPool::wait() {
+    assert(currentWorker() == -1);
+    std::unique_lock<std::mutex> lock(mutex_m);
+    allTasksDone_m.wait(lock, [this] { return unfinishedTasks_m == 0; });
+}
+
+int ThreadPool::size() const {
+    return threads_m.size();
+}
+
+int ThreadPool::currentWorker() const {
+    return currentThreadPool == this ? currentThreadWorker : -1;
+}
+
+TaskGroup::TaskGroup(ThreadPool& threadPool) : threadPool_m(threadPool) {}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::run(ThreadPool::Task task) {
+    pendingTasks_m.fetch_add(1, std::memory_order_relaxed);
+    threadPool_m.submit([this, task = std::move(task)](int worker) {
+        task(worker);
+        pendingTasks_m.fetch_sub(1, std::memory_order_release);
+    });
+}
+
+void TaskGroup::wait() {
+    int worker = threadPool_m.currentWorker();
+    while (pendingTasks_m.load(std::memory_order_acquire) > 0)
+        if (worker == -1 || !threadPool_m.runPendingTask(worker))
+            std::this_thread::yield();
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef MY_THREAD_POOL_H
+#define MY_THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <pthread.h>
+
+// fixed set of worker threads, each with its own deque of tasks: a worker runs its newest
+// task first and, when it has none, steals the oldest task of another worker (tasks
+// submitted from outside the pool go to a shared queue), each task receives the index
+// of the worker running it
+class ThreadPool {
+public:
+    using Task = std::function<void(int)>;
+
+private:
+    struct TaskQueue {
+        std::mutex mutex{};
+        std::deque<Task> tasks{};
+    };
+
+    std::vector<pthread_t> threads_m{};
+    // one queue per worker, the last one is the shared queue
+    std::vector<std::unique_ptr<TaskQueue>> queues_m{};
+    std::atomic<int> queuedTasks_m{0};
+    int unfinishedTasks_m{0};
+    std::mutex mutex_m{};
+    std::condition_variable taskAvailable_m{};
+    std::condition_variable allTasksDone_m{};
+    bool isStopping_m{false};
+
+    static void* startWorker(void* argument);
+    void workerLoop(int worker);
+    bool popTask(int queue, bool isNewest, Task& task);
+    void finishTask();
+
+public:
+    ThreadPool(int numberOfThreads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(Task task);
+    // runs one queued task on the calling worker, false if there was none
+    bool runPendingTask(int worker);
+    // blocks until every submitted task has been run
+    void wait();
+    int size() const;
+    // index of the worker of this pool running the calling thread, -1 for other threads
+    int currentWorker() const;
+};
+
+// fork-join on a ThreadPool: wait returns when all the tasks run by the group are done,
+// a worker waiting runs queued tasks in the meantime (so nested groups cannot deadlock)
+class TaskGroup {
+private:
+    ThreadPool& threadPool_m;
+    std::atomic<int> pendingTasks_m{0};
+
+public:
+    TaskGroup(ThreadPool& threadPool);
+    ~TaskGroup();
+
+    void run(ThreadPool::Task task);
+    void wait();
+};
+
+#endif
\ No newline at end of file
@@ -8,10 +8,10 @@ bool contains(const std::vector<T>& vec, T value) {
     return std::find(vec.begin(), vec.end(), value) != vec.end();
 }
 
-template <typename T>
-int findIndex(const std::vector<T>& vec, T value) {
-    for (int i = 0; i < vec.size(); ++i)
-        if (vec[i] == value)
+template <typename Container, typename T>
+int findIndex(const Container& container, T value) {
+    for (int i = 0; i < container.size(); ++i)
+        if (container[i] == value)
             return i;
     return -1;
 }
@@ -0,0 +1,75 @@
+#include "workspace.hpp"
+
+#include <algorithm>
+
+void EpochMarker::reset(int size) {
+    if (stamps_m.size() < size)
+        stamps_m.resize(size, 0);
+    ++epoch_m;
+    if (epoch_m == 0) { // epoch wrapped around, old stamps could look current
+        std::fill(stamps_m.begin(), stamps_m.end(), 0);
+        epoch_m = 1;
+    }
+}
+
+void EpochMarker::mark(int node) {
+    stamps_m[node] = epoch_m;
+}
+
+void EpochMarker::unmark(int node) {
+    stamps_m[node] = 0;
+}
+
+bool EpochMarker::isMarked(int node) const {
+    return stamps_m[node] == epoch_m;
+}
+
+void ParityUnionFind::reset(int size) {
+    parent_m.resize(size);
+    parity_m.assign(size, 0);
+    rank_m.assign(size, 0);
+    for (int node = 0; node < size; ++node)
+        parent_m[node] = node;
+}
+
+// path compression in two passes: the parity to the root is known only at the root,
+// then every node on the path is hung from the root with its own parity to it
+int ParityUnionFind::find(int node) {
+    int root = node;
+    int parity = 0;
+    while (parent_m[root] != root) {
+        parity ^= parity_m[root];
+        root = parent_m[root];
+    }
+    while (node != root) {
+        int parent = parent_m[node];
+        int parentParity = parity ^ parity_m[node];
+        parent_m[node] = root;
+        parity_m[node] = parity;
+        parity = parentParity;
+        node = parent;
+    }
+    return root;
+}
+
+int ParityUnionFind::parityOf(int node) {
+    find(node);
+    return parity_m[node];
+}
+
+bool ParityUnionFind::join(int node, int other) {
+    int root = find(node);
+    int otherRoot = find(other);
+    int parity = parity_m[node] ^ parity_m[other];
+    if (root == otherRoot) return parity == 1;
+    if (rank_m[root] < rank_m[otherRoot]) std::swap(root, otherRoot);
+    if (rank_m[root] == rank_m[otherRoot]) ++rank_m[root];
+    parent_m[otherRoot] = root;
+    parity_m[otherRoot] = parity ^ 1;
+    return true;
+}
+
+void EmbedderWorkspace::reserveNodes(int size) {
+    if (nodeMap.size() < size)
+        nodeMap.resize(size);
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef MY_WORKSPACE_H
+#define MY_WORKSPACE_H
+
+#include <vector>
+#include <utility>
+
+// set of marked nodes that is emptied in O(1): a node is marked
+// if its stamp equals the current epoch, reset just moves to a new epoch
+class EpochMarker {
+private:
+    std::vector<unsigned int> stamps_m{};
+    unsigned int epoch_m{0};
+
+public:
+    void reset(int size);
+    void mark(int node);
+    void unmark(int node);
+    bool isMarked(int node) const;
+};
+
+// union-find that keeps the parity of the path from each node to the root of its set:
+// joining two nodes says they get different colors, so a join inside a set between two
+// nodes with the same parity closes an odd cycle. reset makes every node its own set
+class ParityUnionFind {
+private:
+    std::vector<int> parent_m{};
+    // with respect to the parent, 0 for a root
+    std::vector<unsigned char> parity_m{};
+    std::vector<unsigned char> rank_m{};
+
+public:
+    void reset(int size);
+    int find(int node);
+    // color of node with respect to the root of its set
+    int parityOf(int node);
+    // false (and nothing changes) if node and other already have the same parity in one set
+    bool join(int node, int other);
+};
+
+// scratch memory shared by all the steps of the embedder: every step uses it only
+// before recursing (never across a recursive call), so one workspace serves the whole
+// recursion, and keeping it in the Embedder lets consecutive graphs reuse its buffers
+class EmbedderWorkspace {
+public:
+    // biconnected components
+    std::vector<int> nodeId{};
+    std::vector<int> prevOfNode{};
+    std::vector<int> lowPoint{};
+    std::vector<int> nextNeighborIndex{};
+    std::vector<int> dfsStack{};
+    std::vector<int> stackOfNodes{};
+    std::vector<std::pair<int, int>> stackOfEdges{};
+    // cycles, segments and interlacement graphs
+    EpochMarker visited{};
+    std::vector<int> nodeMap{};
+    std::vector<int> queue{};
+    std::vector<std::pair<int, int>> segmentDfsStack{};
+    std::vector<int> segmentNodes{};
+    std::vector<std::pair<int, int>> segmentEdges{};
+    std::vector<std::pair<int, int>> conflicts{};
+    ParityUnionFind conflictParity{};
+    // merge of the segments embeddings
+    std::vector<int> segmentsMinAttachment{};
+    std::vector<int> segmentsMaxAttachment{};
+
+    // makes sure nodeMap can be indexed by the nodes of a graph with size nodes
+    void reserveNodes(int size);
+};
+
+#endif
\ No newline at end of file